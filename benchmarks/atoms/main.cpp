@@ -0,0 +1,86 @@
+#include <nodes/Atom>
+#include <nodes/NodeData>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QString>
+
+#include <random>
+#include <vector>
+
+#include "Benchmark.hpp"
+
+using QtNodes::Atom;
+
+static int const TypeCount = 64;
+
+static int const PairCount = 1000000;
+
+static int const Iterations = 10;
+
+
+int
+main(int argc, char *argv[])
+{
+  QCoreApplication app(argc, argv);
+
+  // long ids with a shared prefix, as reverse domain names tend to be
+  std::vector<QString> ids;
+
+  // separate copies, the way ids of two model instances are
+  std::vector<QString> copies;
+
+  for (int i = 0; i < TypeCount; ++i)
+  {
+    ids.push_back(QString("org.example.nodes.types.DataType%1").arg(i));
+    copies.push_back(QString(ids.back().constData(), ids.back().size()));
+  }
+
+  std::vector<NodeDataType> types;
+
+  for (auto const& id : ids)
+    types.push_back(NodeDataType{id, id});
+
+  // what the drag checks compare: mostly types that differ late, some equal
+  std::mt19937 random(42);
+  std::uniform_int_distribution<int> pick(0, TypeCount - 1);
+
+  std::vector<std::pair<int, int>> pairs;
+  pairs.reserve(PairCount);
+
+  for (int i = 0; i < PairCount; ++i)
+    pairs.emplace_back(pick(random), pick(random));
+
+  int equal = 0;
+
+  report("string comparison",
+         averageMilliseconds(Iterations, [&]{ equal = 0; }, [&]
+         {
+           for (auto const& pair : pairs)
+             equal += ids[pair.first] == copies[pair.second];
+         }) * 1e6 / PairCount,
+         "ns");
+
+  int const equalStrings = equal;
+
+  report("atom comparison",
+         averageMilliseconds(Iterations, [&]{ equal = 0; }, [&]
+         {
+           for (auto const& pair : pairs)
+             equal += types[pair.first].atom() == types[pair.second].atom();
+         }) * 1e6 / PairCount,
+         "ns");
+
+  if (equal != equalStrings)
+    std::printf("atoms disagree with the strings\n");
+
+  // paid once per NodeDataType, on a known string
+  report("interning a known id",
+         averageMilliseconds(Iterations, []{}, [&]
+         {
+           for (int i = 0; i < PairCount; ++i)
+             equal += Atom(ids[i % TypeCount]).value() != 0;
+         }) * 1e6 / PairCount,
+         "ns");
+
+  return 0;
+}
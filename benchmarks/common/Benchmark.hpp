@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdio>
+#include <memory>
+
+#include <QtCore/QElapsedTimer>
+
+#include <nodes/NodeData>
+#include <nodes/NodeDataModel>
+#include <nodes/DataModelRegistry>
+
+using QtNodes::DataModelRegistry;
+using QtNodes::NodeData;
+using QtNodes::NodeDataModel;
+using QtNodes::NodeDataType;
+using QtNodes::PortIndex;
+using QtNodes::PortType;
+
+/// Helpers shared by the benchmarks. Each benchmark is a plain executable
+/// printing one line per measurement; build them with BUILD_BENCHMARKS and
+/// a release configuration.
+
+class PassThroughData : public NodeData
+{
+public:
+
+  NodeDataType
+  type() const override
+  {
+    return NodeDataType {"PassThroughData",
+                         "Pass Through Data"};
+  }
+};
+
+/// Two inputs and two outputs of one type, the last input is handed on
+class PassThroughModel : public NodeDataModel
+{
+public:
+
+  QString
+  caption() const override
+  { return QString("Pass Through"); }
+
+  QString
+  name() const override
+  { return QString("PassThroughModel"); }
+
+  std::unique_ptr<NodeDataModel>
+  clone() const override
+  { return std::make_unique<PassThroughModel>(); }
+
+public:
+
+  unsigned int
+  nPorts(PortType portType) const override
+  { return portType == PortType::None ? 0 : 2; }
+
+  NodeDataType
+  dataType(PortType, PortIndex) const override
+  { return PassThroughData().type(); }
+
+  void
+  setInData(std::shared_ptr<NodeData> data, PortIndex) override
+  { _data = std::move(data); }
+
+  std::shared_ptr<NodeData>
+  outData(PortIndex) override
+  { return _data; }
+
+  QWidget *
+  embeddedWidget() override { return nullptr; }
+
+private:
+
+  std::shared_ptr<NodeData> _data;
+};
+
+
+inline
+std::shared_ptr<DataModelRegistry>
+benchmarkRegistry()
+{
+  auto ret = std::make_shared<DataModelRegistry>();
+
+  ret->registerModel<PassThroughModel>();
+
+  return ret;
+}
+
+
+/// Average of `iterations` runs of `body`, in milliseconds. `setUp` runs
+/// before each of them and isn't timed.
+template<typename SetUp, typename Body>
+double
+averageMilliseconds(int iterations, SetUp setUp, Body body)
+{
+  qint64 total = 0;
+
+  for (int i = 0; i < iterations; ++i)
+  {
+    setUp();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    body();
+
+    total += timer.nsecsElapsed();
+  }
+
+  return total / 1e6 / iterations;
+}
+
+
+inline
+void
+report(char const* what, double value, char const* unit)
+{
+  std::printf("%-48s %12.3f %s\n", what, value, unit);
+}
@@ -0,0 +1,137 @@
+#include <nodes/DataFlowScene>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QUuid>
+
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Benchmark.hpp"
+
+using QtNodes::ConnectionID;
+
+/// The hash before the fields were mixed, for comparison
+struct XorConnectionHash
+{
+  size_t
+  operator()(ConnectionID const& id) const
+  {
+    return qHash(id.rNodeID) ^ qHash(id.lNodeID) ^
+           std::hash<PortIndex>()(id.lPortID) ^ std::hash<PortIndex>()(id.rPortID);
+  }
+};
+
+
+/// Every node is connected with its `neighbours` successors in both
+/// directions and between every pair of ports, so reversed and port
+/// swapped ids are common, as in real graphs with feedback
+static
+std::vector<ConnectionID>
+buildConnections(int nodeCount, int neighbours, int ports)
+{
+  std::vector<QUuid> nodes;
+
+  for (int i = 0; i < nodeCount; ++i)
+    nodes.push_back(QUuid::createUuid());
+
+  std::vector<ConnectionID> ids;
+
+  for (int i = 0; i < nodeCount; ++i)
+  {
+    for (int d = 1; d <= neighbours; ++d)
+    {
+      QUuid const& a = nodes[i];
+      QUuid const& b = nodes[(i + d) % nodeCount];
+
+      for (int p = 0; p < ports; ++p)
+      {
+        for (int q = 0; q < ports; ++q)
+        {
+          ids.push_back(ConnectionID{a, b, p, q});
+          ids.push_back(ConnectionID{b, a, p, q});
+        }
+      }
+    }
+  }
+
+  return ids;
+}
+
+
+template<typename Hash>
+void
+measure(std::string const& name, std::vector<ConnectionID> const& ids)
+{
+  Hash hash;
+
+  std::unordered_set<size_t> values;
+
+  for (auto const& id : ids)
+    values.insert(hash(id));
+
+  report((name + " full hash collisions").c_str(),
+         100.0 * (ids.size() - values.size()) / ids.size(),
+         "%");
+
+  std::unordered_map<ConnectionID, int, Hash> map;
+  map.reserve(ids.size());
+
+  for (auto const& id : ids)
+    map.emplace(id, 0);
+
+  size_t shared = 0;
+
+  for (auto const& id : ids)
+  {
+    if (map.bucket_size(map.bucket(id)) > 1)
+      ++shared;
+  }
+
+  report((name + " keys sharing a bucket").c_str(),
+         100.0 * shared / ids.size(),
+         "%");
+
+  int const iterations = 10;
+
+  double const ms =
+    averageMilliseconds(iterations, []{}, [&]
+    {
+      int found = 0;
+
+      for (auto const& id : ids)
+        found += static_cast<int>(map.count(id));
+
+      // keeps the lookups from being optimized out
+      if (found != static_cast<int>(ids.size()))
+        std::printf("lookup failed\n");
+    });
+
+  report((name + " lookup").c_str(), ms * 1e6 / ids.size(), "ns");
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  QCoreApplication app(argc, argv);
+
+  auto const ids = buildConnections(2000, 4, 4);
+
+  std::printf("%d connection ids\n", static_cast<int>(ids.size()));
+
+  // chance that a key shares its bucket with another under a random hash
+  std::unordered_map<ConnectionID, int> reference;
+  reference.reserve(ids.size());
+
+  double const load = double(ids.size()) / reference.bucket_count();
+
+  report("random hash keys sharing a bucket", 100.0 * (1.0 - std::exp(-load)), "%");
+
+  measure<XorConnectionHash>("xor", ids);
+  measure<std::hash<ConnectionID>>("mixed", ids);
+
+  return 0;
+}
@@ -0,0 +1,194 @@
+#include <nodes/DataFlowScene>
+#include <nodes/FlatFlowModel>
+
+#include <QtCore/QPointF>
+#include <QtWidgets/QApplication>
+
+#include <memory>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "Benchmark.hpp"
+
+using QtNodes::DataFlowModel;
+using QtNodes::FlatFlowModel;
+using QtNodes::FlowSceneModel;
+using QtNodes::NodeIndex;
+
+static int const NodeCount = 50000;
+
+static int const Iterations = 10;
+
+static int const BuildIterations = 3;
+
+
+/// Bytes in use on the heap, -1 where the C library can't tell
+static
+qint64
+heapInUse()
+{
+#if defined(__GLIBC__)
+#if __GLIBC_PREREQ(2, 33)
+  return static_cast<qint64>(mallinfo2().uordblks);
+#else
+  return static_cast<qint64>(mallinfo().uordblks);
+#endif
+#else
+  return -1;
+#endif
+}
+
+
+static
+void
+reportBytesPerNode(char const* what, qint64 before, qint64 after)
+{
+  if (before < 0)
+  {
+    std::printf("%-48s %12s\n", what, "n/a");
+    return;
+  }
+
+  report(what, double(after - before) / NodeCount, "bytes");
+}
+
+
+/// Same chain as the serialization benchmark: every node feeds the next
+/// one and the one after that
+static
+std::vector<NodeIndex>
+buildGraph(FlowSceneModel& model)
+{
+  std::vector<NodeIndex> nodes;
+  nodes.reserve(NodeCount);
+
+  for (int i = 0; i < NodeCount; ++i)
+    nodes.push_back(model.nodeIndex(model.addNode("PassThroughModel", QPointF())));
+
+  for (int i = 1; i < NodeCount; ++i)
+  {
+    model.addConnection(nodes[i - 1], 0, nodes[i], 0);
+
+    if (i > 1)
+      model.addConnection(nodes[i - 2], 1, nodes[i], 1);
+  }
+
+  return nodes;
+}
+
+
+/// Visits the downstream end of every connection once
+static
+double
+sweepMilliseconds(FlowSceneModel const& model, std::vector<NodeIndex> const& nodes)
+{
+  return averageMilliseconds(Iterations, []{}, [&]
+  {
+    int visited = 0;
+
+    for (auto const& index : nodes)
+    {
+      for (PortIndex port = 0; port < 2; ++port)
+      {
+        model.visitNodePortConnections(index, PortType::Out, port,
+                                       [&](NodeIndex const&, PortIndex) { ++visited; });
+      }
+    }
+
+    if (visited != 2 * NodeCount - 3)
+      std::printf("traversal failed\n");
+  });
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  QApplication app(argc, argv);
+
+  auto registry = benchmarkRegistry();
+
+  std::printf("%d nodes, %d connections\n", NodeCount, 2 * NodeCount - 3);
+
+  qint64 before = heapInUse();
+
+  DataFlowModel dataFlow(registry);
+  auto const dataFlowNodes = buildGraph(dataFlow);
+
+  reportBytesPerNode("DataFlowModel heap per node", before, heapInUse());
+
+  before = heapInUse();
+
+  FlatFlowModel flat(registry);
+  auto const flatNodes = buildGraph(flat);
+
+  // runs a rebuild of the adjacency arrays if one is due
+  flat.forEachConnection(0, PortType::Out, 0, [](FlatFlowModel::Handle, PortIndex) {});
+
+  reportBytesPerNode("FlatFlowModel heap per node", before, heapInUse());
+
+  // additions, with the checks every addConnection() makes
+  report("DataFlowModel build",
+         averageMilliseconds(BuildIterations, []{}, [&]
+         {
+           DataFlowModel model(registry);
+           buildGraph(model);
+         }),
+         "ms");
+
+  report("FlatFlowModel build",
+         averageMilliseconds(BuildIterations, []{}, [&]
+         {
+           FlatFlowModel model(registry);
+           buildGraph(model);
+         }),
+         "ms");
+
+  report("DataFlowModel visitNodePortConnections sweep",
+         sweepMilliseconds(dataFlow, dataFlowNodes),
+         "ms");
+
+  report("DataFlowModel nodePortConnections sweep",
+         averageMilliseconds(Iterations, []{}, [&]
+         {
+           std::size_t visited = 0;
+
+           for (auto const& index : dataFlowNodes)
+           {
+             for (PortIndex port = 0; port < 2; ++port)
+               visited += dataFlow.nodePortConnections(index, PortType::Out, port).size();
+           }
+
+           if (visited != static_cast<std::size_t>(2 * NodeCount - 3))
+             std::printf("traversal failed\n");
+         }),
+         "ms");
+
+  report("FlatFlowModel visitNodePortConnections sweep",
+         sweepMilliseconds(flat, flatNodes),
+         "ms");
+
+  report("FlatFlowModel forEachConnection sweep",
+         averageMilliseconds(Iterations, []{}, [&]
+         {
+           int visited = 0;
+
+           for (FlatFlowModel::Handle node = 0; node < flat.nodeSlotCount(); ++node)
+           {
+             for (PortIndex port = 0; port < 2; ++port)
+             {
+               flat.forEachConnection(node, PortType::Out, port,
+                                      [&](FlatFlowModel::Handle, PortIndex) { ++visited; });
+             }
+           }
+
+           if (visited != 2 * NodeCount - 3)
+             std::printf("traversal failed\n");
+         }),
+         "ms");
+
+  return 0;
+}
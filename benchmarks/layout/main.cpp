@@ -0,0 +1,167 @@
+#include <nodes/DataFlowScene>
+#include <nodes/NodeGeometry>
+#include <nodes/StaticTextCache>
+
+#include <QtCore/QPointF>
+#include <QtGui/QFont>
+#include <QtGui/QFontMetrics>
+#include <QtGui/QImage>
+#include <QtGui/QPainter>
+#include <QtWidgets/QApplication>
+
+#include <vector>
+
+#include "Benchmark.hpp"
+
+using QtNodes::DataFlowModel;
+using QtNodes::DataFlowScene;
+using QtNodes::NodeGeometry;
+using QtNodes::NodeIndex;
+using QtNodes::StaticTextCache;
+
+static int const NodeCount = 1000;
+
+static int const Iterations = 20;
+
+// keeps the compiler from dropping the measured reads
+static volatile int sink = 0;
+
+
+/// The text measuring every paint did before NodeGeometry cached it
+static
+void
+measureUncached(DataFlowModel const& model, NodeIndex const& index, QFont const& font)
+{
+  QFont bold = font;
+  bold.setBold(true);
+
+  int total = QFontMetrics(bold).boundingRect(model.nodeCaption(index)).width();
+
+  QFontMetrics metrics(font);
+
+  for (auto portType : {PortType::In, PortType::Out})
+  {
+    for (unsigned int i = 0; i < model.nodePortCount(index, portType); ++i)
+    {
+      QString label = model.nodePortCaption(index, portType, i);
+
+      if (label.isEmpty())
+        label = model.nodePortDataType(index, portType, i).name;
+
+      total += metrics.boundingRect(label).width();
+    }
+  }
+
+  sink = sink + total;
+}
+
+
+/// The same information read from the layout cache
+static
+void
+readCached(NodeGeometry const& geom)
+{
+  int total = geom.captionWidth();
+
+  for (auto portType : {PortType::In, PortType::Out})
+  {
+    unsigned int const n = portType == PortType::In ? geom.nSinks() : geom.nSources();
+
+    for (unsigned int i = 0; i < n; ++i)
+      total += geom.portLabelRect(portType, i).width();
+  }
+
+  sink = sink + total;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  QApplication app(argc, argv);
+
+  QFont const font;
+
+  DataFlowModel model(benchmarkRegistry());
+
+  std::vector<NodeIndex>    nodes;
+  std::vector<NodeGeometry> geometries;
+  nodes.reserve(NodeCount);
+  geometries.reserve(NodeCount);
+
+  for (int i = 0; i < NodeCount; ++i)
+  {
+    nodes.push_back(model.nodeIndex(model.addNode("PassThroughModel", QPointF())));
+
+    geometries.emplace_back(nodes.back(), font);
+    geometries.back().recalculateSize();
+  }
+
+  auto nothing = []{};
+
+  double const perNode = 1000.0 / NodeCount;
+
+  report("full relayout per node",
+         perNode * averageMilliseconds(Iterations, nothing, [&]
+         {
+           for (auto& geom : geometries)
+             geom.recalculateSize();
+         }),
+         "us");
+
+  report("uncached text measuring per node",
+         perNode * averageMilliseconds(Iterations, nothing, [&]
+         {
+           for (auto const& index : nodes)
+             measureUncached(model, index, font);
+         }),
+         "us");
+
+  report("cached layout reads per node",
+         perNode * averageMilliseconds(Iterations, nothing, [&]
+         {
+           for (auto& geom : geometries)
+             readCached(geom);
+         }),
+         "us");
+
+  report("port hit test per node",
+         perNode * averageMilliseconds(Iterations, nothing, [&]
+         {
+           for (auto& geom : geometries)
+             sink = sink + geom.checkHitScenePoint(PortType::In, geom.portScenePosition(1, PortType::In));
+         }),
+         "us");
+
+  // whole frames, painting reads the same cache
+  DataFlowScene scene(benchmarkRegistry());
+
+  for (int i = 0; i < NodeCount; ++i)
+  {
+    auto& node = scene.createNode(std::make_unique<PassThroughModel>());
+    scene.setNodePosition(node, QPointF(200.0 * (i % 40), 150.0 * (i / 40)));
+  }
+
+  QImage image(1920, 1080, QImage::Format_ARGB32_Premultiplied);
+
+  StaticTextCache::resetStatistics();
+
+  report("scene frame",
+         averageMilliseconds(Iterations,
+                             [&]{ image.fill(Qt::white); },
+                             [&]
+                             {
+                               QPainter painter(&image);
+                               painter.setRenderHint(QPainter::Antialiasing);
+                               scene.render(&painter);
+                             }),
+         "ms");
+
+  auto const statistics = StaticTextCache::statistics();
+
+  report("text cache hit rate",
+         100.0 * statistics.hits / qMax<quint64>(1, statistics.hits + statistics.misses),
+         "%");
+
+  return 0;
+}
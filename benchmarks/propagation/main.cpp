@@ -0,0 +1,230 @@
+#include <nodes/DataFlowRunner>
+#include <nodes/Node>
+
+#include <QtCore/QCoreApplication>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+
+using QtNodes::DataFlowModel;
+using QtNodes::DataFlowRunner;
+using QtNodes::Node;
+
+static int const DiamondCount = 1000;
+
+static int const TreeDepth = 12;
+
+static int const LatticeWidth = 64;
+
+static int const LatticeDepth = 64;
+
+static int const Iterations = 10;
+
+static std::size_t setInDataCalls = 0;
+
+
+/// Counts its inputs and hands every one of them on
+class CountingModel : public PassThroughModel
+{
+public:
+
+  std::unique_ptr<NodeDataModel>
+  clone() const override
+  { return std::make_unique<CountingModel>(); }
+
+  void
+  setInData(std::shared_ptr<NodeData> data, PortIndex portIndex) override
+  {
+    ++setInDataCalls;
+
+    PassThroughModel::setInData(std::move(data), portIndex);
+
+    emit dataUpdated(0);
+    emit dataUpdated(1);
+  }
+
+  /// New data on both outputs, as a source node would have
+  void
+  touch()
+  {
+    PassThroughModel::setInData(std::make_shared<PassThroughData>(), 0);
+
+    emit dataUpdated(0);
+    emit dataUpdated(1);
+  }
+};
+
+
+struct Graph
+{
+  std::vector<Node*> sources;
+
+  std::size_t connections = 0;
+};
+
+
+static
+Node&
+addNode(DataFlowModel& model)
+{
+  return model.addNode(std::make_unique<CountingModel>());
+}
+
+
+static
+void
+connect(DataFlowModel& model, Graph& graph, Node& from, PortIndex outPort, Node& to, PortIndex inPort)
+{
+  model.addConnection(model.nodeIndex(from.id()), outPort, model.nodeIndex(to.id()), inPort);
+
+  ++graph.connections;
+}
+
+
+/// Diamonds one after the other, every join waits for both branches
+static
+Graph
+buildDiamonds(DataFlowModel& model)
+{
+  Graph graph;
+
+  Node* top = &addNode(model);
+  graph.sources.push_back(top);
+
+  for (int i = 0; i < DiamondCount; ++i)
+  {
+    Node& left  = addNode(model);
+    Node& right = addNode(model);
+    Node& join  = addNode(model);
+
+    connect(model, graph, *top, 0, left, 0);
+    connect(model, graph, *top, 1, right, 0);
+    connect(model, graph, left, 0, join, 0);
+    connect(model, graph, right, 0, join, 1);
+
+    top = &join;
+  }
+
+  return graph;
+}
+
+
+/// A binary tree reducing all of its leaves into one node
+static
+Graph
+buildTree(DataFlowModel& model)
+{
+  Graph graph;
+
+  std::vector<Node*> level;
+
+  for (int i = 0; i < (1 << TreeDepth); ++i)
+    level.push_back(&addNode(model));
+
+  graph.sources = level;
+
+  while (level.size() > 1)
+  {
+    std::vector<Node*> next;
+
+    for (std::size_t i = 0; i < level.size(); i += 2)
+    {
+      Node& node = addNode(model);
+
+      connect(model, graph, *level[i], 0, node, 0);
+      connect(model, graph, *level[i + 1], 0, node, 1);
+
+      next.push_back(&node);
+    }
+
+    level = std::move(next);
+  }
+
+  return graph;
+}
+
+
+/// Layers where every node fans out to two nodes of the next layer and
+/// every node there fans in from two
+static
+Graph
+buildLattice(DataFlowModel& model)
+{
+  Graph graph;
+
+  std::vector<Node*> layer;
+
+  for (int i = 0; i < LatticeWidth; ++i)
+    layer.push_back(&addNode(model));
+
+  graph.sources = layer;
+
+  for (int depth = 1; depth < LatticeDepth; ++depth)
+  {
+    std::vector<Node*> next;
+
+    for (int i = 0; i < LatticeWidth; ++i)
+      next.push_back(&addNode(model));
+
+    for (int i = 0; i < LatticeWidth; ++i)
+    {
+      connect(model, graph, *layer[i], 0, *next[i], 0);
+      connect(model, graph, *layer[i], 1, *next[(i + 1) % LatticeWidth], 1);
+    }
+
+    layer = std::move(next);
+  }
+
+  return graph;
+}
+
+
+/// Updates every source at once; delivering each connection once is the
+/// least a pass can do
+template<typename Build>
+static
+void
+measure(char const* name, Build build)
+{
+  DataFlowRunner runner(benchmarkRegistry());
+
+  DataFlowModel& model = runner.model();
+
+  Graph const graph = build(model);
+
+  std::string const prefix(name);
+
+  report((prefix + " pass").c_str(),
+         averageMilliseconds(Iterations,
+                             []{ setInDataCalls = 0; },
+                             [&]
+                             {
+                               model.suspendPropagation();
+
+                               for (Node* source : graph.sources)
+                                 static_cast<CountingModel*>(source->nodeDataModel())->touch();
+
+                               model.resumePropagation();
+                             }),
+         "ms");
+
+  report((prefix + " setInData per connection").c_str(),
+         double(setInDataCalls) / graph.connections,
+         "calls");
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  QCoreApplication app(argc, argv);
+
+  measure("diamond chain", buildDiamonds);
+  measure("fan-in tree", buildTree);
+  measure("lattice", buildLattice);
+
+  return 0;
+}
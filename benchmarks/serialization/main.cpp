@@ -0,0 +1,80 @@
+#include <nodes/DataFlowScene>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QPointF>
+#include <QtWidgets/QApplication>
+
+#include <memory>
+#include <vector>
+
+#include "Benchmark.hpp"
+
+using QtNodes::DataFlowModel;
+using QtNodes::NodeIndex;
+using QtNodes::SerializationFormat;
+
+/// A chain of `size` nodes, each also feeding the node two places ahead
+static
+void
+buildGraph(DataFlowModel& model, int size)
+{
+  std::vector<NodeIndex> nodes;
+  nodes.reserve(size);
+
+  for (int i = 0; i < size; ++i)
+  {
+    QUuid id = model.addNode("PassThroughModel", QPointF(200.0 * (i % 50), 150.0 * (i / 50)));
+    nodes.push_back(model.nodeIndex(id));
+  }
+
+  for (int i = 1; i < size; ++i)
+  {
+    model.addConnection(nodes[i - 1], 0, nodes[i], 0);
+
+    if (i > 1)
+      model.addConnection(nodes[i - 2], 1, nodes[i], 1);
+  }
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  QApplication app(argc, argv);
+
+  auto registry = benchmarkRegistry();
+
+  int const iterations = 5;
+
+  for (int size : {1000, 10000})
+  {
+    QByteArray json;
+    QByteArray binary;
+    {
+      DataFlowModel model(registry);
+      buildGraph(model, size);
+
+      json   = model.saveToMemory(SerializationFormat::Json);
+      binary = model.saveToMemory(SerializationFormat::Binary);
+    }
+
+    std::printf("%d nodes, %d connections\n", size, 2 * size - 3);
+
+    report("JSON size", json.size() / 1024.0, "KiB");
+    report("binary size", binary.size() / 1024.0, "KiB");
+
+    std::unique_ptr<DataFlowModel> model;
+
+    auto fresh = [&]{ model.reset(); model.reset(new DataFlowModel(registry)); };
+
+    report("JSON load",
+           averageMilliseconds(iterations, fresh, [&]{ model->loadFromMemory(json); }),
+           "ms");
+
+    report("binary load",
+           averageMilliseconds(iterations, fresh, [&]{ model->loadFromMemory(binary); }),
+           "ms");
+  }
+
+  return 0;
+}
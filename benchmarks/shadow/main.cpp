@@ -0,0 +1,67 @@
+#include <nodes/DataFlowScene>
+#include <nodes/NodeStyle>
+
+#include <QtCore/QPointF>
+#include <QtGui/QImage>
+#include <QtGui/QPainter>
+#include <QtWidgets/QApplication>
+
+#include <memory>
+
+#include "Benchmark.hpp"
+
+using QtNodes::DataFlowScene;
+using QtNodes::NodeStyle;
+
+static int const NodeCount = 300;
+
+static int const Frames = 20;
+
+
+/// Every frame paints all nodes again, as a zoom or a selection change does
+static
+void
+measure(NodeStyle::ShadowMode mode, char const* name)
+{
+  NodeStyle style;
+  style.Shadow = mode;
+
+  DataFlowScene scene(benchmarkRegistry());
+
+  for (int i = 0; i < NodeCount; ++i)
+  {
+    auto model = std::make_unique<PassThroughModel>();
+    model->setNodeStyle(style);
+
+    auto& node = scene.createNode(std::move(model));
+    scene.setNodePosition(node, QPointF(200.0 * (i % 20), 150.0 * (i / 20)));
+  }
+
+  QImage image(1920, 1080, QImage::Format_ARGB32_Premultiplied);
+
+  report(name,
+         averageMilliseconds(Frames,
+                             [&]{ image.fill(Qt::white); },
+                             [&]
+                             {
+                               QPainter painter(&image);
+                               painter.setRenderHint(QPainter::Antialiasing);
+                               scene.render(&painter);
+                             }),
+         "ms");
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  QApplication app(argc, argv);
+
+  std::printf("%d nodes per frame\n", NodeCount);
+
+  measure(NodeStyle::ShadowMode::None, "no shadow frame");
+  measure(NodeStyle::ShadowMode::Effect, "effect shadow frame");
+  measure(NodeStyle::ShadowMode::Painted, "painted shadow frame");
+
+  return 0;
+}
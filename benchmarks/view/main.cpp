@@ -0,0 +1,130 @@
+#include <nodes/DataFlowScene>
+#include <nodes/FlowView>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QPointF>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLFunctions>
+#include <QtWidgets/QApplication>
+#include <QtWidgets/QOpenGLWidget>
+
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+
+using QtNodes::DataFlowScene;
+using QtNodes::FlowView;
+using QtNodes::Node;
+
+static int const NodeCounts[] = {250, 1000, 4000, 16000};
+
+static int const Frames = 100;
+
+
+/// Paints the viewport right away and waits until the frame is done
+static
+void
+renderFrame(FlowView& view)
+{
+  view.viewport()->repaint();
+
+  if (view.viewportMode() == FlowView::ViewportMode::OpenGL)
+  {
+    auto widget = static_cast<QOpenGLWidget*>(view.viewport());
+
+    widget->makeCurrent();
+    widget->context()->functions()->glFinish();
+    widget->doneCurrent();
+  }
+}
+
+
+static
+void
+measure(FlowView& view, char const* name)
+{
+  std::string const prefix(name);
+
+  // the item caches stay valid while panning
+  report((prefix + " pan frame").c_str(),
+         averageMilliseconds(Frames,
+                             [&]{ view.setSceneRect(view.sceneRect().translated(10.0, 0.0)); },
+                             [&]{ renderFrame(view); }),
+         "ms");
+
+  // every zoom step repaints the nodes
+  int step = 0;
+
+  report((prefix + " zoom frame").c_str(),
+         averageMilliseconds(Frames,
+                             [&]
+                             {
+                               double const factor = (step++ % 2 == 0) ? 1.05 : 1.0 / 1.05;
+                               view.scale(factor, factor);
+                             },
+                             [&]{ renderFrame(view); }),
+         "ms");
+}
+
+
+/// A chain of `nodeCount` nodes shown in both viewport modes
+static
+void
+measureScene(int nodeCount)
+{
+  DataFlowScene scene(benchmarkRegistry());
+
+  std::vector<Node*> nodes;
+
+  for (int i = 0; i < nodeCount; ++i)
+  {
+    auto& node = scene.createNode(std::make_unique<PassThroughModel>());
+    scene.setNodePosition(node, QPointF(200.0 * (i % 50), 150.0 * (i / 50)));
+
+    if (!nodes.empty())
+      scene.createConnection(node, 0, *nodes.back(), 0);
+
+    nodes.push_back(&node);
+  }
+
+  FlowView view(&scene);
+  view.resize(1280, 800);
+  view.show();
+
+  // let the window be exposed before timing
+  for (int i = 0; i < 10; ++i)
+    QCoreApplication::processEvents();
+
+  // zoomed out far enough to show a few hundred nodes
+  view.scale(0.5, 0.5);
+
+  std::printf("%d nodes, %dx%d viewport\n", nodeCount, view.viewport()->width(), view.viewport()->height());
+
+  view.setViewportMode(FlowView::ViewportMode::Raster);
+  QCoreApplication::processEvents();
+
+  measure(view, "raster");
+
+  if (view.setViewportMode(FlowView::ViewportMode::OpenGL) != FlowView::ViewportMode::OpenGL)
+  {
+    std::printf("OpenGL is not available here, skipped\n");
+    return;
+  }
+
+  QCoreApplication::processEvents();
+
+  measure(view, "OpenGL");
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  QApplication app(argc, argv);
+
+  for (int nodeCount : NodeCounts)
+    measureScene(nodeCount);
+
+  return 0;
+}
@@ -0,0 +1,130 @@
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+
+#include <nodes/DataFlowRunner>
+#include <nodes/DataModelRegistry>
+#include <nodes/Node>
+
+#include <cstdio>
+
+#include "models.hpp"
+
+using QtNodes::DataFlowModel;
+using QtNodes::DataFlowRunner;
+using QtNodes::DataModelRegistry;
+using QtNodes::Node;
+
+static std::shared_ptr<DataModelRegistry>
+registerDataModels()
+{
+  auto ret = std::make_shared<DataModelRegistry>();
+
+  ret->registerModel<SourceModel>();
+  ret->registerModel<SlowSumModel>();
+  ret->registerModel<AsyncDoubleModel>();
+  ret->registerModel<RewiringModel>();
+
+  return ret;
+}
+
+
+static
+void
+link(DataFlowModel& model, Node& from, PortIndex outPort, Node& to, PortIndex inPort)
+{
+  model.addConnection(model.nodeIndex(from.id()), outPort,
+                      model.nodeIndex(to.id()), inPort);
+}
+
+
+static
+double
+resultOf(DataFlowRunner const& runner, Node const& node)
+{
+  auto number = std::dynamic_pointer_cast<NumberData>(runner.outData(node.id(), 0));
+
+  return number ? number->number() : -1.0;
+}
+
+
+//------------------------------------------------------------------------------
+
+/// Evaluates a small diamond-shaped graph with parallel execution turned on.
+///
+///   a = s1 + s2, b = s3 + s4, c = s1 + s4    computed on the pool
+///   d = a + b,   e = b + c,   f = d + e
+///   g = 2 f                                  computeAsync()
+///   r = g                                    connects r to h on the way
+///   h = c + r
+int
+main(int argc, char* argv[])
+{
+  QCoreApplication app(argc, argv);
+
+  DataFlowRunner runner(registerDataModels());
+
+  DataFlowModel& model = runner.model();
+  model.setParallelExecution(true);
+
+  Node* sources[4];
+
+  for (auto& source : sources)
+    source = &model.addNode(std::make_unique<SourceModel>());
+
+  auto sum = [&](Node& left, Node& right) -> Node&
+             {
+               Node& node = model.addNode(std::make_unique<SlowSumModel>());
+               link(model, left, 0, node, 0);
+               link(model, right, 0, node, 1);
+               return node;
+             };
+
+  Node& a = sum(*sources[0], *sources[1]);
+  Node& b = sum(*sources[2], *sources[3]);
+  Node& c = sum(*sources[0], *sources[3]);
+  Node& d = sum(a, b);
+  Node& e = sum(b, c);
+  Node& f = sum(d, e);
+
+  Node& g = model.addNode(std::make_unique<AsyncDoubleModel>());
+  link(model, f, 0, g, 0);
+
+  auto rewiring = std::make_unique<RewiringModel>();
+  RewiringModel* rewiringModel = rewiring.get();
+
+  Node& r = model.addNode(std::move(rewiring));
+  link(model, g, 0, r, 0);
+
+  Node& h = model.addNode(std::make_unique<SlowSumModel>());
+  link(model, c, 0, h, 0);
+
+  // edits the graph while the executor is in the middle of a pass
+  rewiringModel->onFirstData = [&]{ link(model, r, 0, h, 1); };
+
+  QElapsedTimer timer;
+  timer.start();
+
+  for (int i = 0; i < 4; ++i)
+    static_cast<SourceModel*>(sources[i]->nodeDataModel())->setNumber(i + 1);
+
+  double const expected = 49.0;
+
+  // the async result comes back through the event loop
+  while (resultOf(runner, h) != expected && timer.elapsed() < 10000)
+  {
+    QCoreApplication::processEvents();
+    model.waitForPropagation();
+  }
+
+  double const result = resultOf(runner, h);
+
+  std::printf("h = %g after %lld ms\n", result, static_cast<long long>(timer.elapsed()));
+
+  if (result != expected)
+  {
+    std::printf("expected %g\n", expected);
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,96 @@
+#include "models.hpp"
+
+#include <cmath>
+
+double
+busyWork(double value, CancellationToken const* token)
+{
+  double noise = 0.0;
+
+  for (int i = 0; i < 2000000; ++i)
+  {
+    if (token != nullptr && (i % 65536) == 0 && token->isCancelled())
+      break;
+
+    noise += std::sqrt(static_cast<double>(i));
+  }
+
+  // always zero, but the compiler can't tell
+  return value + (noise < 0.0 ? noise : 0.0);
+}
+
+
+void
+SourceModel::
+setNumber(double number)
+{
+  _number = std::make_shared<NumberData>(number);
+
+  emit dataUpdated(0);
+}
+
+
+void
+SlowSumModel::
+setInData(std::shared_ptr<NodeData> data, PortIndex portIndex)
+{
+  _inputs[portIndex] = std::dynamic_pointer_cast<NumberData>(data);
+
+  if (_inputs[0] && _inputs[1])
+  {
+    _result = std::make_shared<NumberData>(busyWork(_inputs[0]->number() +
+                                                    _inputs[1]->number()));
+  }
+  else
+  {
+    _result.reset();
+  }
+
+  emit dataUpdated(0);
+}
+
+
+void
+AsyncDoubleModel::
+setInData(std::shared_ptr<NodeData> data, PortIndex)
+{
+  auto number = std::dynamic_pointer_cast<NumberData>(data);
+
+  if (!number)
+  {
+    cancelComputation();
+
+    _result.reset();
+    emit dataUpdated(0);
+
+    return;
+  }
+
+  double const value = number->number();
+
+  computeAsync([value](CancellationToken const& token)
+               { return busyWork(2.0 * value, &token); },
+               [this](double result)
+               {
+                 _result = std::make_shared<NumberData>(result);
+                 emit dataUpdated(0);
+               });
+}
+
+
+void
+RewiringModel::
+setInData(std::shared_ptr<NodeData> data, PortIndex)
+{
+  _data = std::move(data);
+
+  if (_data && onFirstData)
+  {
+    auto callback = std::move(onFirstData);
+    onFirstData = nullptr;
+
+    callback();
+  }
+
+  emit dataUpdated(0);
+}
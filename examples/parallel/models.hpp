@@ -0,0 +1,215 @@
+#pragma once
+
+#include <QtCore/QObject>
+
+#include <nodes/NodeData>
+#include <nodes/NodeDataModel>
+
+#include <functional>
+#include <memory>
+
+using QtNodes::CancellationToken;
+using QtNodes::NodeData;
+using QtNodes::NodeDataModel;
+using QtNodes::NodeDataType;
+using QtNodes::PortIndex;
+using QtNodes::PortType;
+
+class NumberData : public NodeData
+{
+public:
+
+  NumberData(double number)
+    : _number(number)
+  {}
+
+  NodeDataType
+  type() const override
+  {
+    return NodeDataType {"number",
+                         "Number"};
+  }
+
+  double
+  number() const { return _number; }
+
+private:
+
+  double _number;
+};
+
+/// Stands in for real work, a few milliseconds of it
+double
+busyWork(double value, CancellationToken const* token = nullptr);
+
+//------------------------------------------------------------------------------
+
+/// A number set from outside with setNumber()
+class SourceModel : public NodeDataModel
+{
+  Q_OBJECT
+
+public:
+
+  QString
+  caption() const override { return QStringLiteral("Source"); }
+
+  QString
+  name() const override { return QStringLiteral("Source"); }
+
+  std::unique_ptr<NodeDataModel>
+  clone() const override { return std::make_unique<SourceModel>(); }
+
+  unsigned int
+  nPorts(PortType portType) const override
+  { return portType == PortType::Out ? 1 : 0; }
+
+  NodeDataType
+  dataType(PortType, PortIndex) const override
+  { return NumberData(0.0).type(); }
+
+  void
+  setInData(std::shared_ptr<NodeData>, PortIndex) override {}
+
+  std::shared_ptr<NodeData>
+  outData(PortIndex) override { return _number; }
+
+  QWidget *
+  embeddedWidget() override { return nullptr; }
+
+  void
+  setNumber(double number);
+
+private:
+
+  std::shared_ptr<NumberData> _number;
+};
+
+//------------------------------------------------------------------------------
+
+/// Adds its inputs. Thread safe, so with parallel execution it runs on the
+/// executor's pool and independent sums compute at the same time.
+class SlowSumModel : public NodeDataModel
+{
+  Q_OBJECT
+
+public:
+
+  QString
+  caption() const override { return QStringLiteral("Slow Sum"); }
+
+  QString
+  name() const override { return QStringLiteral("SlowSum"); }
+
+  std::unique_ptr<NodeDataModel>
+  clone() const override { return std::make_unique<SlowSumModel>(); }
+
+  unsigned int
+  nPorts(PortType portType) const override
+  { return portType == PortType::In ? 2 : 1; }
+
+  NodeDataType
+  dataType(PortType, PortIndex) const override
+  { return NumberData(0.0).type(); }
+
+  void
+  setInData(std::shared_ptr<NodeData> data, PortIndex portIndex) override;
+
+  std::shared_ptr<NodeData>
+  outData(PortIndex) override { return _result; }
+
+  QWidget *
+  embeddedWidget() override { return nullptr; }
+
+  bool
+  threadSafe() const override { return true; }
+
+private:
+
+  std::shared_ptr<NumberData> _inputs[2];
+
+  std::shared_ptr<NumberData> _result;
+};
+
+//------------------------------------------------------------------------------
+
+/// Doubles its input with computeAsync(), the result arrives through the
+/// event loop and starts a pass of its own
+class AsyncDoubleModel : public NodeDataModel
+{
+  Q_OBJECT
+
+public:
+
+  QString
+  caption() const override { return QStringLiteral("Async Double"); }
+
+  QString
+  name() const override { return QStringLiteral("AsyncDouble"); }
+
+  std::unique_ptr<NodeDataModel>
+  clone() const override { return std::make_unique<AsyncDoubleModel>(); }
+
+  unsigned int
+  nPorts(PortType) const override { return 1; }
+
+  NodeDataType
+  dataType(PortType, PortIndex) const override
+  { return NumberData(0.0).type(); }
+
+  void
+  setInData(std::shared_ptr<NodeData> data, PortIndex) override;
+
+  std::shared_ptr<NodeData>
+  outData(PortIndex) override { return _result; }
+
+  QWidget *
+  embeddedWidget() override { return nullptr; }
+
+private:
+
+  std::shared_ptr<NumberData> _result;
+};
+
+//------------------------------------------------------------------------------
+
+/// Passes its input on. The first time it gets some it calls `onFirstData`,
+/// which edits the graph from inside setInData(), on the GUI thread and in
+/// the middle of a pass.
+class RewiringModel : public NodeDataModel
+{
+  Q_OBJECT
+
+public:
+
+  QString
+  caption() const override { return QStringLiteral("Rewiring"); }
+
+  QString
+  name() const override { return QStringLiteral("Rewiring"); }
+
+  std::unique_ptr<NodeDataModel>
+  clone() const override { return std::make_unique<RewiringModel>(); }
+
+  unsigned int
+  nPorts(PortType) const override { return 1; }
+
+  NodeDataType
+  dataType(PortType, PortIndex) const override
+  { return NumberData(0.0).type(); }
+
+  void
+  setInData(std::shared_ptr<NodeData> data, PortIndex) override;
+
+  std::shared_ptr<NodeData>
+  outData(PortIndex) override { return _data; }
+
+  QWidget *
+  embeddedWidget() override { return nullptr; }
+
+  std::function<void()> onFirstData;
+
+private:
+
+  std::shared_ptr<NodeData> _data;
+};
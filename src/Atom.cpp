@@ -0,0 +1,107 @@
+#include "Atom.hpp"
+
+#include <vector>
+
+#include <QtCore/QReadLocker>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QWriteLocker>
+
+namespace QtNodes {
+
+namespace {
+
+struct AtomTable
+{
+  QReadWriteLock lock;
+
+  QHash<QString, quint32> values;
+
+  // indexed by atom value, the null atom is the empty string
+  std::vector<QString> strings{QString()};
+};
+
+
+AtomTable&
+atomTable()
+{
+  static AtomTable table;
+
+  return table;
+}
+
+
+quint32
+internValue(QString& string)
+{
+  if (string.isEmpty())
+    return 0;
+
+  auto& table = atomTable();
+
+  {
+    QReadLocker locker(&table.lock);
+
+    auto iter = table.values.constFind(string);
+
+    if (iter != table.values.constEnd())
+    {
+      string = table.strings[iter.value()];
+
+      return iter.value();
+    }
+  }
+
+  QWriteLocker locker(&table.lock);
+
+  // someone else may have been quicker
+  auto iter = table.values.constFind(string);
+
+  if (iter != table.values.constEnd())
+  {
+    string = table.strings[iter.value()];
+
+    return iter.value();
+  }
+
+  auto value = static_cast<quint32>(table.strings.size());
+
+  table.strings.push_back(string);
+  table.values.insert(string, value);
+
+  return value;
+}
+}
+
+Atom::
+Atom(QString const& string)
+{
+  QString copy = string;
+
+  _value = internValue(copy);
+}
+
+
+Atom
+Atom::
+intern(QString& string)
+{
+  Atom atom;
+
+  atom._value = internValue(string);
+
+  return atom;
+}
+
+
+QString
+Atom::
+toString() const
+{
+  auto& table = atomTable();
+
+  QReadLocker locker(&table.lock);
+
+  return table.strings[_value];
+}
+
+} // namespace QtNodes
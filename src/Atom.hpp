@@ -0,0 +1,79 @@
+#pragma once
+
+#include <functional>
+
+#include <QtCore/QHash>
+#include <QtCore/QString>
+
+#include "Export.hpp"
+
+namespace QtNodes
+{
+
+/// Small integer standing for an interned string, used for type and model
+/// ids so they compare and hash as integers.
+///
+/// Equal strings always intern to the same atom for the lifetime of the
+/// process, the empty string to the null atom. The string table only
+/// grows, and it is safe to intern from any thread.
+class NODE_EDITOR_PUBLIC Atom
+{
+public:
+
+  Atom() = default;
+
+  explicit
+  Atom(QString const& string);
+
+  /// Interns `string` and replaces it with the table's copy, so all
+  /// strings of one atom share their data
+  static
+  Atom
+  intern(QString& string);
+
+public:
+
+  bool
+  isNull() const { return _value == 0; }
+
+  quint32
+  value() const { return _value; }
+
+  /// The table's copy of the interned string
+  QString
+  toString() const;
+
+  bool
+  operator==(Atom const& other) const { return _value == other._value; }
+
+  bool
+  operator!=(Atom const& other) const { return _value != other._value; }
+
+  bool
+  operator<(Atom const& other) const { return _value < other._value; }
+
+private:
+
+  quint32 _value = 0;
+};
+
+
+inline uint
+qHash(Atom const& atom, uint seed = 0)
+{
+  return qHash(atom.value(), seed);
+}
+}
+
+namespace std
+{
+template<>
+struct hash<QtNodes::Atom>
+{
+  std::size_t
+  operator()(QtNodes::Atom const& atom) const
+  {
+    return atom.value();
+  }
+};
+}
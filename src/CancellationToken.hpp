@@ -0,0 +1,29 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace QtNodes
+{
+
+/// Shared flag handed to asynchronous work so it can stop early once
+/// its result is no longer wanted. Copies observe the same flag.
+class CancellationToken
+{
+public:
+
+  CancellationToken()
+    : _cancelled(std::make_shared<std::atomic<bool>>(false))
+  {}
+
+  bool
+  isCancelled() const { return *_cancelled; }
+
+  void
+  cancel() const { *_cancelled = true; }
+
+private:
+
+  std::shared_ptr<std::atomic<bool>> _cancelled;
+};
+}
@@ -87,6 +87,12 @@ private:
   PortIndex _outPortIndex;
   PortIndex _inPortIndex;
 
+  friend class Node;
+
+  // positions in the port lists of the nodes, kept up to date by Node
+  std::size_t _outSlot = 0;
+  std::size_t _inSlot  = 0;
+
 private:
 
   ConnectionState    _connectionState;
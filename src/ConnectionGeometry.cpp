@@ -1,12 +1,48 @@
 #include "ConnectionGeometry.hpp"
 
 #include <cmath>
+#include <limits>
+
+#include <QtGui/QPainterPathStroker>
 
 #include "StyleCollection.hpp"
 
 using QtNodes::ConnectionGeometry;
 using QtNodes::PortType;
 
+namespace
+{
+// width of the band around the curve that counts as a hit
+constexpr double HitWidth = 10.0;
+
+QPointF
+bezierPoint(QPointF const* p, double t)
+{
+  double const u = 1.0 - t;
+
+  return u * u * u * p[0] + 3.0 * u * u * t * p[1] +
+         3.0 * u * t * t * p[2] + t * t * t * p[3];
+}
+
+
+QPointF
+bezierDerivative(QPointF const* p, double t)
+{
+  double const u = 1.0 - t;
+
+  return 3.0 * u * u * (p[1] - p[0]) + 6.0 * u * t * (p[2] - p[1]) +
+         3.0 * t * t * (p[3] - p[2]);
+}
+
+
+QPointF
+bezierSecondDerivative(QPointF const* p, double t)
+{
+  return 6.0 * (1.0 - t) * (p[2] - 2.0 * p[1] + p[0]) +
+         6.0 * t * (p[3] - 2.0 * p[2] + p[1]);
+}
+}
+
 ConnectionGeometry::
 ConnectionGeometry()
   : _in(0, 0)
@@ -45,6 +81,8 @@ setEndPoint(PortType portType, QPointF const& point)
     default:
       break;
   }
+
+  invalidate();
 }
 
 
@@ -65,6 +103,8 @@ moveEndPoint(PortType portType, QPointF const &offset)
     default:
       break;
   }
+
+  invalidate();
 }
 
 
@@ -98,6 +138,118 @@ std::pair<QPointF, QPointF>
 ConnectionGeometry::
 pointsC1C2() const
 {
+  updateCache();
+
+  return _c1c2;
+}
+
+
+QPainterPath const&
+ConnectionGeometry::
+cubicPath() const
+{
+  updateCache();
+
+  return _cubicPath;
+}
+
+
+QPainterPath const&
+ConnectionGeometry::
+stroke() const
+{
+  if (!_strokeValid)
+  {
+    QPainterPathStroker stroker;
+    stroker.setWidth(HitWidth);
+
+    _stroke = stroker.createStroke(cubicPath());
+    _strokeValid = true;
+  }
+
+  return _stroke;
+}
+
+
+bool
+ConnectionGeometry::
+curveContains(QPointF const& point) const
+{
+  double const halfWidth = HitWidth / 2.0;
+
+  QPointF const offset(halfWidth, halfWidth);
+
+  QRectF const rect = boundingRect();
+
+  if (!QRectF(rect.topLeft() - offset, rect.bottomRight() + offset).contains(point))
+    return false;
+
+  updateCache();
+
+  QPointF const p[4] = { _out, _c1c2.first, _c1c2.second, _in };
+
+  // the nearest of a few samples seeds Newton's method on
+  // d/dt |B(t) - point|^2 = 0
+  unsigned const samples = 16;
+
+  double bestT = 0.0;
+  double bestDistance = std::numeric_limits<double>::max();
+
+  for (unsigned i = 0; i <= samples; ++i)
+  {
+    double const t = double(i) / samples;
+
+    QPointF const d = bezierPoint(p, t) - point;
+    double const distance = QPointF::dotProduct(d, d);
+
+    if (distance < bestDistance)
+    {
+      bestDistance = distance;
+      bestT = t;
+    }
+  }
+
+  double t = bestT;
+
+  for (int i = 0; i < 4; ++i)
+  {
+    QPointF const d   = bezierPoint(p, t) - point;
+    QPointF const d1  = bezierDerivative(p, t);
+    QPointF const d2  = bezierSecondDerivative(p, t);
+
+    double const numerator   = QPointF::dotProduct(d, d1);
+    double const denominator = QPointF::dotProduct(d1, d1) + QPointF::dotProduct(d, d2);
+
+    if (std::abs(denominator) < 1e-12)
+      break;
+
+    t = qBound(0.0, t - numerator / denominator, 1.0);
+  }
+
+  QPointF const d = bezierPoint(p, t) - point;
+
+  double const distance = std::min(bestDistance, QPointF::dotProduct(d, d));
+
+  return distance <= halfWidth * halfWidth;
+}
+
+
+void
+ConnectionGeometry::
+invalidate()
+{
+  _cacheValid  = false;
+  _strokeValid = false;
+}
+
+
+void
+ConnectionGeometry::
+updateCache() const
+{
+  if (_cacheValid)
+    return;
+
   double xDistance = _in.x() - _out.x();
   //double yDistance = _in.y() - _out.y() - 100;
 
@@ -128,5 +280,11 @@ pointsC1C2() const
   QPointF c2(_in.x() - minimum * ratio1,
              _in.y() + verticalOffset);
 
-  return std::make_pair(c1, c2);
+  _c1c2 = std::make_pair(c1, c2);
+
+  // cubic spline
+  _cubicPath = QPainterPath(_out);
+  _cubicPath.cubicTo(c1, c2, _in);
+
+  _cacheValid = true;
 }
@@ -4,6 +4,7 @@
 
 #include <QtCore/QPointF>
 #include <QtCore/QRectF>
+#include <QtGui/QPainterPath>
 
 #include <iostream>
 
@@ -33,6 +34,21 @@ public:
   std::pair<QPointF, QPointF>
   pointsC1C2() const;
 
+  /// The curve between the end points. Cached, like stroke(), until an
+  /// end point changes.
+  QPainterPath const&
+  cubicPath() const;
+
+  /// Outline of the curve widened for hit-testing
+  QPainterPath const&
+  stroke() const;
+
+  /// True if `point` is within half the stroke() width of the curve.
+  /// Solves for the nearest point on the curve instead of testing
+  /// containment in the stroke, which is much cheaper.
+  bool
+  curveContains(QPointF const& point) const;
+
   QPointF
   source() const { return _out; }
   QPointF
@@ -46,11 +62,25 @@ public:
   void
   setHovered(bool hovered) { _hovered = hovered; }
 
+private:
+
+  void
+  invalidate();
+
+  void
+  updateCache() const;
+
 private:
   // local object coordinates
   QPointF _in;
   QPointF _out;
 
+  mutable std::pair<QPointF, QPointF> _c1c2;
+  mutable QPainterPath                _cubicPath;
+  mutable QPainterPath                _stroke;
+  mutable bool                        _cacheValid = false;
+  mutable bool                        _strokeValid = false;
+
   //int _animationPhase;
 
   double _lineWidth;
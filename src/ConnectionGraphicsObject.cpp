@@ -86,12 +86,21 @@ shape() const
 
 #else
 
-  return ConnectionPainter::getPainterStroke(_geometry);
+  return _geometry.stroke();
 
 #endif
 }
 
 
+bool
+ConnectionGraphicsObject::
+contains(QPointF const& point) const
+{
+  // point hit tests (hover, clicks) skip the stroked outline entirely
+  return _geometry.curveContains(point);
+}
+
+
 void
 ConnectionGraphicsObject::
 setGeometryChanged()
@@ -123,7 +132,7 @@ ConnectionGraphicsObject::dataType() const
   auto dataType = _scene.model()->nodePortDataType(validNode, validType, portIndex(validType));
 
   // make sure it matches the other side
-  Q_ASSERT(!node(oppositePort(validType)).isValid() || dataType.id == node(oppositePort(validType)).model()->nodePortDataType(node(oppositePort(validType)), oppositePort(validType), portIndex(oppositePort(validType))).id);
+  Q_ASSERT(!node(oppositePort(validType)).isValid() || dataType.atom() == node(oppositePort(validType)).model()->nodePortDataType(node(oppositePort(validType)), oppositePort(validType), portIndex(oppositePort(validType))).atom());
 
   return dataType;
 }
@@ -132,37 +141,36 @@ void
 ConnectionGraphicsObject::
 move()
 {
+  // the ends are kept in item coordinates
+  QTransform const sceneToItem = sceneTransform().inverted();
 
-  auto moveEndPoint =
-  [this] (PortType portType)
+  auto endPoint =
+  [&] (PortType portType)
   {
-    auto nodeIndex = node(portType);
-
-    auto const &nodeGraphics = *_scene.nodeGraphicsObject(nodeIndex);
-
-    auto const &nodeGeom = nodeGraphics.geometry();
+    auto const &nodeGraphics = *_scene.nodeGraphicsObject(node(portType));
 
     QPointF scenePos =
-      nodeGeom.portScenePosition(portIndex(portType),
-                                  portType,
-                                  nodeGraphics.sceneTransform());
+      nodeGraphics.geometry().portScenePosition(portIndex(portType),
+                                                portType,
+                                                nodeGraphics.sceneTransform());
 
-    {
-      QTransform sceneTrans = sceneTransform();
+    return sceneToItem.map(scenePos);
+  };
 
-      QPointF connectionPos = sceneTrans.inverted().map(scenePos);
+  QPointF const in  = endPoint(PortType::In);
+  QPointF const out = endPoint(PortType::Out);
 
-      _geometry.setEndPoint(portType,
-                                                    connectionPos);
+  if (in == _geometry.getEndPoint(PortType::In) &&
+      out == _geometry.getEndPoint(PortType::Out))
+    return;
 
-      setGeometryChanged();
-      update();
+  // one geometry change for both ends
+  setGeometryChanged();
 
-    }
-  };
+  _geometry.setEndPoint(PortType::In, in);
+  _geometry.setEndPoint(PortType::Out, out);
 
-  moveEndPoint(PortType::In);
-  moveEndPoint(PortType::Out);
+  update();
 }
 
 void ConnectionGraphicsObject::lock(bool locked)
@@ -239,8 +247,8 @@ mouseReleaseEvent(QGraphicsSceneMouseEvent* event)
   ungrabMouse();
   event->accept();
 
-  auto node = locateNodeAt(event->scenePos(), _scene,
-                           _scene.views()[0]->transform());
+  // only a node with the required port under the cursor can take the end
+  auto node = _scene.portAt(event->scenePos(), _state.requiredPort()).first;
 
   if (!node) {
 
@@ -56,6 +56,9 @@ public:
   QPainterPath
   shape() const override;
 
+  bool
+  contains(QPointF const& point) const override;
+
   void
   setGeometryChanged();
 
@@ -29,7 +29,21 @@ namespace std {
 template<>
 struct hash<::QtNodes::ConnectionID> {
   size_t operator()(::QtNodes::ConnectionID const& toHash) const {
-    return qHash(toHash.rNodeID) ^ qHash(toHash.lNodeID) ^ std::hash<QtNodes::PortIndex>()(toHash.lPortID) ^ std::hash<QtNodes::PortIndex>()(toHash.rPortID);
+    // every field goes through the mixer in turn, so A->B and B->A, or
+    // swapped port indices, end up far apart
+    quint64 h = mix(qHash(toHash.lNodeID));
+    h = mix(h ^ qHash(toHash.rNodeID));
+    h = mix(h ^ ((quint64(quint32(toHash.lPortID)) << 32) | quint32(toHash.rPortID)));
+    return static_cast<size_t>(h);
+  }
+
+private:
+  // splitmix64 finalizer
+  static quint64 mix(quint64 x) {
+    x += Q_UINT64_C(0x9e3779b97f4a7c15);
+    x = (x ^ (x >> 30)) * Q_UINT64_C(0xbf58476d1ce4e5b9);
+    x = (x ^ (x >> 27)) * Q_UINT64_C(0x94d049bb133111eb);
+    return x ^ (x >> 31);
   }
 };
 
@@ -24,17 +24,7 @@ QPainterPath
 ConnectionPainter::
 cubicPath(ConnectionGeometry const& geom)
 {
-  QPointF const& source = geom.source();
-  QPointF const& sink   = geom.sink();
-
-  auto c1c2 = geom.pointsC1C2();
-
-  // cubic spline
-  QPainterPath cubic(source);
-
-  cubic.cubicTo(c1c2.first, c1c2.second, sink);
-
-  return cubic;
+  return geom.cubicPath();
 }
 
 
@@ -42,26 +32,10 @@ QPainterPath
 ConnectionPainter::
 getPainterStroke(ConnectionGeometry const& geom)
 {
-  auto cubic = cubicPath(geom);
-
-  QPointF const& source = geom.source();
-  QPainterPath result(source);
-
-  unsigned segments = 20;
-
-  for (auto i = 0ul; i < segments; ++i)
-  {
-    double ratio = double(i + 1) / segments;
-    result.lineTo(cubic.pointAtPercent(ratio));
-  }
-
-  QPainterPathStroker stroker; stroker.setWidth(10.0);
-
-  return stroker.createStroke(result);
+  return geom.stroke();
 }
 
 
-
 void
 ConnectionPainter::
 paint(QPainter* painter,
@@ -79,7 +53,7 @@ paint(QPainter* painter,
   if (connectionStyle.useDataDefinedColors())
   {
 
-    normalColor   = connectionStyle.normalColor(dataType.id);
+    normalColor   = connectionStyle.normalColor(dataType.atom());
     hoverColor    = normalColor.lighter(200);
     selectedColor = normalColor.darker(200);
   }
@@ -122,7 +96,7 @@ paint(QPainter* painter,
   }
 #endif
 
-  auto cubic = cubicPath(geom);
+  QPainterPath const& cubic = geom.cubicPath();
 
   bool const hovered = geom.hovered();
 
@@ -1,15 +1,24 @@
 #include "ConnectionStyle.hpp"
 
+#include <cstdlib>
 #include <iostream>
+#include <vector>
 
 #include <QtCore/QFile>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
 #include <QtCore/QJsonValueRef>
 #include <QtCore/QJsonArray>
+#include <QtCore/QReadLocker>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QWriteLocker>
 
 #include <QDebug>
 
+#if defined(Q_OS_UNIX)
+#include <unistd.h>
+#endif
+
 #include "StyleCollection.hpp"
 
 using QtNodes::ConnectionStyle;
@@ -162,18 +171,95 @@ QColor
 ConnectionStyle::
 normalColor(QString typeId) const
 {
-    std::size_t hash = qHash(typeId);
+  return dataTypeColor(Atom(typeId));
+}
+
+
+QColor
+ConnectionStyle::
+normalColor(Atom typeId) const
+{
+  return dataTypeColor(typeId);
+}
+
+
+namespace
+{
+
+/// The first qrand() after qsrand(seed), without touching the state of
+/// either. Colors used to be picked that way and must not change.
+int
+firstRandomNumber(uint seed)
+{
+#if defined(Q_OS_UNIX) && defined(_POSIX_THREAD_SAFE_FUNCTIONS) && (_POSIX_THREAD_SAFE_FUNCTIONS - 0 > 0)
+  // what qrand() runs on here
+  return rand_r(&seed);
+#else
+  // qrand() is the CRT's rand() here, the same LCG without its global state
+  seed = seed * 214013u + 2531011u;
+  return static_cast<int>((seed >> 16) & 0x7fff);
+#endif
+}
+
+
+struct DataTypeColorTable
+{
+  QReadWriteLock lock;
+
+  // indexed by atom value, 0 where not computed yet; computed colors
+  // are opaque so they are never 0
+  std::vector<QRgb> colors;
+};
+
+
+DataTypeColorTable&
+dataTypeColorTable()
+{
+  static DataTypeColorTable table;
+
+  return table;
+}
+
+}
+
+
+QColor
+ConnectionStyle::
+dataTypeColor(Atom typeId)
+{
+  auto& table = dataTypeColorTable();
 
-    std::size_t const hue_range = 0xFF;
+  {
+    QReadLocker locker(&table.lock);
+
+    if (typeId.value() < table.colors.size() && table.colors[typeId.value()] != 0)
+    {
+      return QColor::fromRgba(table.colors[typeId.value()]);
+    }
+  }
+
+  uint const hash = qHash(typeId.toString());
+
+  QWriteLocker locker(&table.lock);
+
+  std::size_t const hue_range = 0xFF;
 
-    qsrand(hash);
-    std::size_t hue = qrand() % hue_range;
+  std::size_t hue = firstRandomNumber(hash) % hue_range;
+
+  std::size_t sat = 120 + hash % 129;
+
+  QColor color = QColor::fromHsl(hue,
+                                 sat,
+                                 160);
+
+  if (typeId.value() >= table.colors.size())
+  {
+    table.colors.resize(typeId.value() + 1, 0);
+  }
 
-    std::size_t sat = 120 + hash % 129;
+  table.colors[typeId.value()] = color.rgba();
 
-    return QColor::fromHsl(hue,
-                         sat,
-                         160);
+  return color;
 }
 
 
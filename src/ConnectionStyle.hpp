@@ -3,6 +3,7 @@
 #include <QtGui/QColor>
 
 #include "Export.hpp"
+#include "Atom.hpp"
 #include "Style.hpp"
 
 namespace QtNodes
@@ -20,6 +21,12 @@ public:
 
   static void setConnectionStyle(QString jsonText);
 
+  /// Color of connections carrying `typeId` when useDataDefinedColors()
+  /// is on. Computed once per type, then looked up in a table shared by
+  /// all threads. DataModelRegistry precomputes the types of registered
+  /// models.
+  static QColor dataTypeColor(Atom typeId);
+
 private:
 
   void loadJsonText(QString jsonText) override;
@@ -33,6 +40,7 @@ public:
   QColor constructionColor() const;
   QColor normalColor() const;
   QColor normalColor(QString typeId) const;
+  QColor normalColor(Atom typeId) const;
   QColor selectedColor() const;
   QColor selectedHaloColor() const;
   QColor hoveredColor() const;
@@ -0,0 +1,419 @@
+#include "DataFlowExecutor.hpp"
+
+#include <map>
+
+#include <QtCore/QMetaObject>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QRunnable>
+
+#include <QDebug>
+
+#include "Node.hpp"
+#include "Connection.hpp"
+#include "NodeDataModel.hpp"
+
+namespace QtNodes {
+
+namespace {
+
+bool
+isConnected(Node& node, PortIndex outPort, Node& target, PortIndex inPort)
+{
+  for (Connection* conn : node.connections(PortType::Out, outPort))
+  {
+    if (conn->getNode(PortType::In) == &target &&
+        conn->getPortIndex(PortType::In) == inPort)
+      return true;
+  }
+
+  return false;
+}
+}
+
+
+struct DataFlowExecutor::Task
+{
+  struct Edge
+  {
+    Task*     target;
+    PortIndex outPort;
+    PortIndex inPort;
+  };
+
+  Node* node = nullptr;
+
+  std::vector<Edge> downstream;
+
+  // upstream edges inside the pass that have not delivered yet
+  std::size_t pendingUpstream = 0;
+
+  std::map<PortIndex, std::shared_ptr<NodeData>> inputs;
+
+  // guarded by _captureMutex while the node is computing
+  std::set<PortIndex> dirtyOutputs;
+
+  std::vector<std::pair<PortIndex, std::shared_ptr<NodeData>>> outputs;
+
+  std::atomic<bool> computing{false};
+};
+
+
+class DataFlowExecutor::TaskRunnable : public QRunnable
+{
+public:
+
+  TaskRunnable(DataFlowExecutor& executor, Task& task)
+    : _executor(executor)
+    , _task(task)
+  {}
+
+  void
+  run() override
+  {
+    _executor.compute(_task);
+    _executor.postCompleted(_task);
+  }
+
+private:
+
+  DataFlowExecutor& _executor;
+  Task&             _task;
+};
+
+
+DataFlowExecutor::
+DataFlowExecutor(QObject* parent)
+  : QObject(parent)
+{}
+
+
+DataFlowExecutor::
+~DataFlowExecutor()
+{
+  _pool.waitForDone();
+}
+
+
+void
+DataFlowExecutor::
+setMaxThreadCount(int count)
+{
+  _pool.setMaxThreadCount(count);
+}
+
+
+int
+DataFlowExecutor::
+maxThreadCount() const
+{
+  return _pool.maxThreadCount();
+}
+
+
+void
+DataFlowExecutor::
+run(DirtyOutputs const& dirtyOutputs)
+{
+  Q_ASSERT(!_running);
+
+  if (dirtyOutputs.empty())
+    return;
+
+  // one task for every node downstream of the dirty outputs
+  std::vector<Node*> stack;
+  for (auto const& pair : dirtyOutputs)
+  {
+    stack.push_back(pair.first);
+  }
+
+  while (!stack.empty())
+  {
+    Node* node = stack.back();
+    stack.pop_back();
+
+    if (_tasks.find(node) != _tasks.end())
+      continue;
+
+    auto task = std::make_unique<Task>();
+    task->node = node;
+    _tasks[node] = std::move(task);
+
+    auto nOut = node->nodeDataModel()->nPorts(PortType::Out);
+    for (PortIndex portIndex = 0; portIndex < static_cast<PortIndex>(nOut); ++portIndex)
+    {
+      for (Connection* conn : node->connections(PortType::Out, portIndex))
+      {
+        stack.push_back(conn->getNode(PortType::In));
+      }
+    }
+  }
+
+  // wire the edges, connections are snapshotted for the whole pass
+  for (auto const& pair : _tasks)
+  {
+    Task& task = *pair.second;
+
+    auto nOut = task.node->nodeDataModel()->nPorts(PortType::Out);
+    for (PortIndex portIndex = 0; portIndex < static_cast<PortIndex>(nOut); ++portIndex)
+    {
+      for (Connection* conn : task.node->connections(PortType::Out, portIndex))
+      {
+        Task& target = *_tasks[conn->getNode(PortType::In)];
+
+        task.downstream.push_back({&target, portIndex, conn->getPortIndex(PortType::In)});
+        ++target.pendingUpstream;
+      }
+    }
+  }
+
+  for (auto const& pair : dirtyOutputs)
+  {
+    _tasks[pair.first]->dirtyOutputs = pair.second;
+  }
+
+  _remaining = _tasks.size();
+
+  // from here on worker threads may look tasks up
+  _running = true;
+
+  // nodes without upstream work in this pass start right away
+  std::vector<Task*> ready;
+  for (auto const& pair : _tasks)
+  {
+    if (pair.second->pendingUpstream == 0)
+      ready.push_back(pair.second.get());
+  }
+
+  for (Task* task : ready)
+  {
+    schedule(*task);
+  }
+
+  // every node sits on a cycle, nothing can start
+  if (ready.empty())
+    finishPass();
+}
+
+
+bool
+DataFlowExecutor::
+captureOutput(Node* node, PortIndex portIndex)
+{
+  if (!_running)
+    return false;
+
+  auto iter = _tasks.find(node);
+
+  if (iter == _tasks.end() || !iter->second->computing)
+    return false;
+
+  QMutexLocker locker(&_captureMutex);
+
+  iter->second->dirtyOutputs.insert(portIndex);
+
+  return true;
+}
+
+
+void
+DataFlowExecutor::
+flush()
+{
+  if (!_running)
+    return;
+
+  bool const wasFlushing = _flushing;
+
+  // everything scheduled from now on runs on this thread
+  _flushing = true;
+
+  while (_running && _inFlight > _computeDepth)
+  {
+    _pool.waitForDone();
+
+    processCompleted();
+
+    while (!_mainThreadReady.empty())
+    {
+      runMainThreadTask();
+    }
+  }
+
+  _flushing = wasFlushing;
+}
+
+
+void
+DataFlowExecutor::
+graphChanged()
+{
+  if (_running)
+    _edgesStale = true;
+}
+
+
+void
+DataFlowExecutor::
+schedule(Task& task)
+{
+  ++_inFlight;
+
+  // nothing to compute, don't bother the pool
+  bool const idle = task.inputs.empty() && task.dirtyOutputs.empty();
+
+  if (!_flushing && !idle && task.node->nodeDataModel()->threadSafe())
+  {
+    _pool.start(new TaskRunnable(*this, task));
+  }
+  else
+  {
+    _mainThreadReady.push_back(&task);
+
+    QMetaObject::invokeMethod(this, "runMainThreadTask", Qt::QueuedConnection);
+  }
+}
+
+
+void
+DataFlowExecutor::
+compute(Task& task)
+{
+  auto model = task.node->nodeDataModel();
+
+  task.computing = true;
+
+  if (!task.inputs.empty())
+  {
+    model->enterComputing();
+
+    for (auto const& input : task.inputs)
+    {
+      model->setInData(input.second, input.first);
+    }
+  }
+
+  task.computing = false;
+
+  std::set<PortIndex> dirtyOutputs;
+  {
+    QMutexLocker locker(&_captureMutex);
+
+    dirtyOutputs.swap(task.dirtyOutputs);
+  }
+
+  for (PortIndex portIndex : dirtyOutputs)
+  {
+    task.outputs.emplace_back(portIndex, model->outData(portIndex));
+  }
+}
+
+
+void
+DataFlowExecutor::
+postCompleted(Task& task)
+{
+  {
+    QMutexLocker locker(&_completedMutex);
+
+    _completed.push_back(&task);
+  }
+
+  QMetaObject::invokeMethod(this, "processCompleted", Qt::QueuedConnection);
+}
+
+
+void
+DataFlowExecutor::
+processCompleted()
+{
+  std::vector<Task*> completed;
+  {
+    QMutexLocker locker(&_completedMutex);
+
+    completed.swap(_completed);
+  }
+
+  for (Task* task : completed)
+  {
+    complete(*task);
+  }
+}
+
+
+void
+DataFlowExecutor::
+runMainThreadTask()
+{
+  // queued invocations can outlive the task they were posted for
+  if (_mainThreadReady.empty())
+    return;
+
+  Task* task = _mainThreadReady.front();
+  _mainThreadReady.pop_front();
+
+  ++_computeDepth;
+
+  compute(*task);
+
+  --_computeDepth;
+
+  complete(*task);
+}
+
+
+void
+DataFlowExecutor::
+complete(Task& task)
+{
+  --_inFlight;
+  --_remaining;
+
+  if (!task.inputs.empty())
+  {
+    task.node->nodeDataModel()->leaveComputing();
+  }
+
+  for (auto const& edge : task.downstream)
+  {
+    bool const connected =
+      !_edgesStale || isConnected(*task.node, edge.outPort, *edge.target->node, edge.inPort);
+
+    for (auto const& output : task.outputs)
+    {
+      if (connected && output.first == edge.outPort)
+        edge.target->inputs[edge.inPort] = output.second;
+    }
+
+    if (--edge.target->pendingUpstream == 0)
+      schedule(*edge.target);
+  }
+
+  task.inputs.clear();
+  task.outputs.clear();
+
+  if (_inFlight == 0)
+    finishPass();
+}
+
+
+void
+DataFlowExecutor::
+finishPass()
+{
+  if (_remaining != 0)
+  {
+    qWarning() << "DataFlowExecutor: skipped" << _remaining
+               << "nodes that depend on themselves";
+  }
+
+  _tasks.clear();
+  _mainThreadReady.clear();
+
+  _remaining  = 0;
+  _edgesStale = false;
+  _running    = false;
+
+  emit finished();
+}
+
+} // namespace QtNodes
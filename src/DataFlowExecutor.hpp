@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include <QtCore/QObject>
+#include <QtCore/QMutex>
+#include <QtCore/QThreadPool>
+
+#include "PortType.hpp"
+
+namespace QtNodes
+{
+
+class Node;
+
+/// Runs a propagation pass of a DataFlowModel on a thread pool.
+///
+/// A pass covers every node downstream of the dirty outputs it is started
+/// with. A node is scheduled as soon as all of its upstream nodes in the
+/// pass are done, so independent branches compute concurrently. Models that
+/// report NodeDataModel::threadSafe() run on the pool, all others on the
+/// thread owning the executor. A node is computing from before its inputs
+/// are applied until its outputs are collected; this nests with the
+/// model's own computeAsync(), so NodeDataModel::computingStarted() and
+/// computingFinished() are emitted once per outermost bracket.
+class DataFlowExecutor : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  using DirtyOutputs = std::unordered_map<Node*, std::set<PortIndex>>;
+
+  DataFlowExecutor(QObject* parent = nullptr);
+
+  ~DataFlowExecutor();
+
+public:
+
+  void
+  setMaxThreadCount(int count);
+
+  int
+  maxThreadCount() const;
+
+  bool
+  isRunning() const { return _running; }
+
+  /// Starts a pass. The executor must not be running.
+  void
+  run(DirtyOutputs const& dirtyOutputs);
+
+  /// Called for every NodeDataModel::dataUpdated. Returns true if the node
+  /// is being computed by the running pass, in which case the port is
+  /// delivered by the pass itself.
+  bool
+  captureOutput(Node* node, PortIndex portIndex);
+
+  /// Completes the running pass, and any pass started from `finished`,
+  /// on the calling thread before returning.
+  ///
+  /// Called from a node computing on this thread, e.g. one whose setInData()
+  /// edits the graph, the pass can't end before that node returns; then
+  /// everything that doesn't wait for it is run, and the rest is left to
+  /// the pass.
+  void
+  flush();
+
+  /// Connections were added or removed while a pass is running. From then
+  /// on the pass only delivers along connections that still exist.
+  void
+  graphChanged();
+
+signals:
+
+  void
+  finished();
+
+private slots:
+
+  void
+  processCompleted();
+
+  void
+  runMainThreadTask();
+
+private:
+
+  struct Task;
+
+  class TaskRunnable;
+
+  void
+  schedule(Task& task);
+
+  void
+  compute(Task& task);
+
+  void
+  complete(Task& task);
+
+  void
+  postCompleted(Task& task);
+
+  void
+  finishPass();
+
+private:
+
+  QThreadPool _pool;
+
+  std::unordered_map<Node*, std::unique_ptr<Task>> _tasks;
+
+  std::deque<Task*> _mainThreadReady;
+
+  // tasks finished on the pool, waiting to be completed on our thread
+  std::vector<Task*> _completed;
+  QMutex             _completedMutex;
+
+  QMutex _captureMutex;
+
+  std::atomic<bool> _running{false};
+  bool              _flushing = false;
+
+  // tasks computing on our thread, nested when a flush runs more of them
+  std::size_t _computeDepth = 0;
+
+  // the snapshot of the connections taken by run() is out of date
+  bool _edgesStale = false;
+
+  std::size_t _inFlight  = 0;
+  std::size_t _remaining = 0;
+};
+}
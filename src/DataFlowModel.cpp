@@ -2,13 +2,42 @@
 
 #include "Node.hpp"
 #include "Connection.hpp"
+#include "DataFlowExecutor.hpp"
+#include "FlowBinaryFormat.hpp"
+#include "JsonRecordReader.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+
+#include <QtCore/QBuffer>
+#include <QtCore/QHash>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
 
 namespace QtNodes {
 
+namespace {
+// rank of the nodes missing from the topological order
+constexpr std::size_t CyclicRank = std::numeric_limits<std::size_t>::max();
+
+// records between two loadProgress() signals
+constexpr std::size_t LoadProgressInterval = 1024;
+}
+
 DataFlowModel::DataFlowModel(std::shared_ptr<DataModelRegistry> registry) 
 : _registry(std::move(registry)) {
 }
 
+DataFlowModel::~DataFlowModel() {
+  // the nodes go away before our QObject children do
+  waitForPropagation();
+}
+
 
 // FlowSceneModel read interface
 QStringList DataFlowModel::modelRegistry() const {
@@ -27,12 +56,24 @@ QStringList DataFlowModel::modelRegistry() const {
   return {};
 }
 QString DataFlowModel::converterNode(NodeDataType const& lhs, NodeDataType const& rhs) const {
-  auto conv =  _registry->getTypeConverter(lhs.id, rhs.id);
+  auto conv = _registry->typeConverter(lhs.id, rhs.id);
 
   if (!conv) return {};
 
-  return conv->name();
+  return conv->ModelName;
+  }
+QStringList DataFlowModel::converterNodes(NodeDataType const& lhs, NodeDataType const& rhs) const {
+  QStringList ret;
+
+  for (auto conv : _registry->typeConverterChain(lhs.atom(), rhs.atom())) {
+    ret.push_back(conv->ModelName);
   }
+  return ret;
+}
+bool DataFlowModel::canConvert(NodeDataType const& lhs, NodeDataType const& rhs) const {
+  // the cached chain, nothing is copied
+  return !_registry->typeConverterChain(lhs.atom(), rhs.atom()).empty();
+}
   QList<QUuid> DataFlowModel::nodeUUids() const {
   QList<QUuid> ret;
 
@@ -107,6 +148,18 @@ NodePainterDelegate* DataFlowModel::nodePainterDelegate(NodeIndex const& index)
 
   return node->nodeDataModel()->painterDelegate();
   }
+  NodeStyle DataFlowModel::nodeStyle(NodeIndex const& index) const {
+  return *nodeStyleHandle(index);
+  }
+  NodeStyleHandle DataFlowModel::nodeStyleHandle(NodeIndex const& index) const {
+  Q_ASSERT(index.isValid());
+
+  auto* node = static_cast<Node*>(index.internalPointer());
+
+  auto const& style = node->nodeDataModel()->nodeStyleHandle();
+
+  return style ? style : StyleCollection::nodeStyleHandle();
+  }
   unsigned int DataFlowModel::nodePortCount(NodeIndex const& index, PortType portType) const {
   Q_ASSERT(index.isValid());
 
@@ -144,11 +197,23 @@ std::vector<std::pair<NodeIndex, PortIndex>> DataFlowModel::nodePortConnections(
   auto* node = static_cast<Node*>(index.internalPointer());
 
   std::vector<std::pair<NodeIndex, PortIndex>> ret;
+  ret.reserve(node->connections(portType, id).size());
   // construct connections
+  visitNodePortConnections(index, portType, id, [&](NodeIndex const& other, PortIndex otherPort) {
+    ret.emplace_back(other, otherPort);
+  });
+  return ret;
+}
+void DataFlowModel::visitNodePortConnections(NodeIndex const& index, PortType portType, PortIndex id, ConnectionVisitor visitor) const {
+  Q_ASSERT(index.isValid());
+
+  auto* node = static_cast<Node*>(index.internalPointer());
+
   for (const auto& conn : node->connections(portType, id)) {
-    ret.emplace_back(nodeIndex(conn->getNode(oppositePort(portType))->id()), conn->getPortIndex(oppositePort(portType)));
+    // the node is right there, no need to look it up by id
+    Node* other = conn->getNode(oppositePort(portType));
+    visitor(createIndex(other->id(), other), conn->getPortIndex(oppositePort(portType)));
   }
-  return ret;
 }
 
 // FlowSceneModel write interface
@@ -165,24 +230,26 @@ bool DataFlowModel::removeConnection(NodeIndex const& leftNodeIdx, PortIndex lef
   connID.lPortID = leftPortID;
   connID.rPortID = rightPortID;
 
-  // update the node
-  _connections[connID]->propagateEmptyData();
+  waitForPropagation();
+
+  auto connIter = _connections.find(connID);
+  Q_ASSERT(connIter != _connections.end());
+
+  Connection* conn = connIter->second.get();
 
-  // remove it from the nodes
-  auto& leftConns = leftNode->connections(PortType::Out, leftPortID);
-  auto iter = std::find_if(leftConns.begin(), leftConns.end(), [&](Connection* conn){ return conn->id() == connID; });
-  Q_ASSERT(iter != leftConns.end());
-  leftConns.erase(iter);
+  // update the node
+  conn->propagateEmptyData();
 
-  auto& rightConns = rightNode->connections(PortType::In, rightPortID);
-  iter = std::find_if(rightConns.begin(), rightConns.end(), [&](Connection* conn){ return conn->id() == connID; });
-  Q_ASSERT(iter != rightConns.end());
-  rightConns.erase(iter);
+  // remove it from the nodes, the connection knows where it is in their lists
+  leftNode->detachConnection(PortType::Out, leftPortID, conn);
+  rightNode->detachConnection(PortType::In, rightPortID, conn);
 
   emit connectionAboutToBeRemoved(leftNodeIdx, leftPortID, rightNodeIdx, rightPortID);
 
   // remove it from the map
-  _connections.erase(connID);
+  _connections.erase(connIter);
+
+  invalidateTopologicalOrder();
 
   // tell the view
   emit connectionRemoved(leftNodeIdx, leftPortID, rightNodeIdx, rightPortID);
@@ -202,19 +269,35 @@ bool DataFlowModel::addConnection(NodeIndex const& leftNodeIdx, PortIndex leftPo
   connID.lPortID = leftPortID;
   connID.rPortID = rightPortID;
 
+  if (leftPortID < 0 || leftPortID >= static_cast<PortIndex>(leftNode->nodeDataModel()->nPorts(PortType::Out)) ||
+      rightPortID < 0 || rightPortID >= static_cast<PortIndex>(rightNode->nodeDataModel()->nPorts(PortType::In))) {
+    return false;
+  }
+
+  // replacing it would leave the old connection in the nodes' port lists
+  if (_connections.find(connID) != _connections.end()) return false;
+
+  waitForPropagation();
+
   // create the connection
   auto conn = std::make_shared<Connection>(*rightNode, rightPortID, *leftNode, leftPortID);
   _connections[connID] = conn;
 
   // add it to the nodes
-  leftNode->connections(PortType::Out, leftPortID).push_back(conn.get());
-  rightNode->connections(PortType::In, rightPortID).push_back(conn.get());
+  leftNode->attachConnection(PortType::Out, leftPortID, conn.get());
+  rightNode->attachConnection(PortType::In, rightPortID, conn.get());
+
+  invalidateTopologicalOrder();
 
   // update the node
-  _connections[connID]->propagateData(leftNode->nodeDataModel()->outData(leftPortID));
+  if (_propagationSuspended) {
+    markOutputDirty(*leftNode, leftPortID);
+  } else {
+    _connections[connID]->propagateData(leftNode->nodeDataModel()->outData(leftPortID));
+  }
 
   // tell the view the connection was added
-  emit connectionAdded(leftNodeIdx, leftPortID, rightNodeIdx, rightPortID);
+  if (!deferToBatch()) emit connectionAdded(leftNodeIdx, leftPortID, rightNodeIdx, rightPortID);
 
   return true;
 }
@@ -233,11 +316,18 @@ bool DataFlowModel::removeNode(NodeIndex const& index) {
   }
   #endif
 
+  waitForPropagation();
+
   emit nodeAboutToBeRemoved(index);
 
+  // forget pending outputs so a running pass doesn't touch the dead node
+  _dirtyOutputs.erase(node);
+
   // remove it from the map
   _nodes.erase(index.id());
 
+  invalidateTopologicalOrder();
+
   // tell the view
   emit nodeRemoved(index.id());
 
@@ -255,9 +345,10 @@ QUuid DataFlowModel::addNode(const QString& typeID, QPointF const& location) {
 
 Node&
 DataFlowModel::
-addNode(std::unique_ptr<NodeDataModel>&& model) {
+addNode(std::unique_ptr<NodeDataModel>&& model, QUuid const& id) {
   // create the UUID
-  QUuid nodeid = QUuid::createUuid();
+  QUuid nodeid = id.isNull() ? QUuid::createUuid() : id;
+  Q_ASSERT(_nodes.find(nodeid) == _nodes.end());
   
   // create a node
   auto modelPtr = model.get(); // cache the ptr
@@ -269,19 +360,38 @@ addNode(std::unique_ptr<NodeDataModel>&& model) {
   // add it to the map
   _nodes[nodeid] = std::move(node);
 
+  invalidateTopologicalOrder();
+
   // connect to the geometry gets updated
-  connect(nodePtr, &Node::positionChanged, this, [this, nodeid](QPointF const&){ nodeMoved(nodeIndex(nodeid)); });
+  connect(nodePtr, &Node::positionChanged, this, [this, nodeid](QPointF const&){
+    if (!deferToBatch()) emit nodeMoved(nodeIndex(nodeid));
+  });
+
+  connect(modelPtr, &NodeDataModel::captionUpdated, this, [this, nodeid] {
+    if (!deferToBatch()) emit nodeCaptionUpdated(nodeIndex(nodeid));
+  });
+  connect(modelPtr, &NodeDataModel::styleUpdated, this, [this, nodeid] {
+    if (!deferToBatch()) emit nodeStyleUpdated(nodeIndex(nodeid));
+  });
 
   // connect to data changes
-  connect(modelPtr, &NodeDataModel::dataUpdated, this, [nodePtr](PortIndex id) {
-    nodePtr->onDataUpdated(id);
-    for (const auto& conn : nodePtr->connections(PortType::Out, id)) {
-      conn->propagateData(nodePtr->nodeDataModel()->outData(id));
+  // direct, so updates from a node running on a worker reach the executor
+  connect(modelPtr, &NodeDataModel::dataUpdated, this, [this, nodePtr, nodeid](PortIndex id) {
+    if (_executor && _executor->captureOutput(nodePtr, id)) return;
+
+    if (QThread::currentThread() != thread()) {
+      QTimer::singleShot(0, this, [this, nodeid, id] {
+        auto iter = _nodes.find(nodeid);
+        if (iter != _nodes.end()) markOutputDirty(*iter->second, id);
+      });
+      return;
     }
-  });
+
+    markOutputDirty(*nodePtr, id);
+  }, Qt::DirectConnection);
 
   // tell the view
-  emit nodeAdded(nodeid);
+  if (!deferToBatch()) emit nodeAdded(nodeid);
   
   return *nodePtr;
 }
@@ -296,6 +406,574 @@ bool DataFlowModel::moveNode(NodeIndex const& index, QPointF newLocation) {
   return true;
 }
 
+void DataFlowModel::markOutputDirty(Node& node, PortIndex portIndex) {
+  auto& ports = _dirtyOutputs[&node];
+  bool const queued = !ports.empty();
+  ports.insert(portIndex);
+
+  // a pass is running; it will pick this port up when it reaches the node
+  if (_propagating) {
+    if (!queued) _dirtyQueue.emplace(topologicalRank(&node), &node);
+    return;
+  }
+
+  if (_propagationSuspended) return;
+
+  if (_executor) {
+    // coalesced into the next pass once the running one is done
+    if (!_executor->isRunning()) startParallelPass();
+    return;
+  }
+
+  propagateDirtyOutputs();
+}
+
+void DataFlowModel::startParallelPass() {
+  auto dirtyOutputs = std::move(_dirtyOutputs);
+  _dirtyOutputs.clear();
+
+  _executor->run(dirtyOutputs);
+}
+
+void DataFlowModel::setParallelExecution(bool enabled) {
+  if (enabled == parallelExecution()) return;
+
+  if (enabled) {
+    _executor = new DataFlowExecutor(this);
+
+    connect(_executor, &DataFlowExecutor::finished, this, [this] {
+      if (!_dirtyOutputs.empty()) startParallelPass();
+    });
+  } else {
+    waitForPropagation();
+
+    delete _executor;
+    _executor = nullptr;
+  }
+}
+
+bool DataFlowModel::parallelExecution() const {
+  return _executor != nullptr;
+}
+
+void DataFlowModel::waitForPropagation() {
+  if (_executor) _executor->flush();
+}
+
+void DataFlowModel::suspendPropagation() {
+  ++_propagationSuspended;
+}
+
+void DataFlowModel::resumePropagation() {
+  Q_ASSERT(_propagationSuspended > 0);
+
+  if (--_propagationSuspended > 0 || _dirtyOutputs.empty()) return;
+
+  if (_executor) {
+    if (!_executor->isRunning()) startParallelPass();
+    return;
+  }
+
+  propagateDirtyOutputs();
+}
+
+QJsonObject DataFlowModel::saveToJson() const {
+  QJsonObject sceneJson;
+
+  QJsonArray nodesJsonArray;
+  for (const auto& pair : _nodes) {
+    nodesJsonArray.append(pair.second->save());
+  }
+  sceneJson["nodes"] = nodesJsonArray;
+
+  QJsonArray connectionJsonArray;
+  for (const auto& pair : _connections) {
+    QJsonObject connectionJson = pair.second->save();
+
+    if (!connectionJson.isEmpty())
+      connectionJsonArray.append(connectionJson);
+  }
+  sceneJson["connections"] = connectionJsonArray;
+
+  return sceneJson;
+}
+
+QByteArray DataFlowModel::saveToBinary() const {
+  QByteArray data;
+  FlowBinaryFormat::Writer writer(data);
+
+  writer.writeMagic();
+  writer.writeVarint(FlowBinaryFormat::CurrentVersion);
+
+  // model names are written once and referred to by index
+  QStringList names;
+  QHash<QString, quint64> nameIndices;
+
+  std::vector<Node const*> nodes;
+  std::vector<quint64> nodeNames;
+  std::vector<QJsonObject> modelJsons;
+  std::unordered_map<Node const*, quint64> nodeIndices;
+
+  nodes.reserve(_nodes.size());
+  nodeNames.reserve(_nodes.size());
+  modelJsons.reserve(_nodes.size());
+
+  for (const auto& pair : _nodes) {
+    Node const* node = pair.second.get();
+
+    QJsonObject modelJson = node->nodeDataModel()->save();
+    QString name = modelJson.take("name").toString();
+
+    auto nameIter = nameIndices.find(name);
+    if (nameIter == nameIndices.end()) {
+      nameIter = nameIndices.insert(name, static_cast<quint64>(names.size()));
+      names.append(name);
+    }
+
+    nodeIndices[node] = nodes.size();
+    nodes.push_back(node);
+    nodeNames.push_back(nameIter.value());
+    modelJsons.push_back(std::move(modelJson));
+  }
+
+  writer.writeVarint(static_cast<quint64>(names.size()));
+  for (const QString& name : names) {
+    writer.writeString(name);
+  }
+
+  writer.writeVarint(nodes.size());
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    Node const* node = nodes[i];
+
+    writer.writeUuid(node->id());
+    writer.writeVarint(nodeNames[i]);
+    writer.writeDouble(node->position().x());
+    writer.writeDouble(node->position().y());
+
+    if (modelJsons[i].isEmpty())
+      writer.writeBytes(QByteArray());
+    else
+      writer.writeBytes(QJsonDocument(modelJsons[i]).toJson(QJsonDocument::Compact));
+  }
+
+  std::vector<Connection const*> connections;
+  connections.reserve(_connections.size());
+  for (const auto& pair : _connections) {
+    Connection const* conn = pair.second.get();
+
+    if (conn->getNode(PortType::In) && conn->getNode(PortType::Out))
+      connections.push_back(conn);
+  }
+
+  writer.writeVarint(connections.size());
+  for (Connection const* conn : connections) {
+    writer.writeVarint(nodeIndices[conn->getNode(PortType::Out)]);
+    writer.writeVarint(static_cast<quint64>(conn->getPortIndex(PortType::Out)));
+    writer.writeVarint(nodeIndices[conn->getNode(PortType::In)]);
+    writer.writeVarint(static_cast<quint64>(conn->getPortIndex(PortType::In)));
+  }
+
+  return data;
+}
+
+QByteArray DataFlowModel::saveToMemory(SerializationFormat format) const {
+  if (format == SerializationFormat::Binary) return saveToBinary();
+
+  QJsonDocument document(saveToJson());
+
+  return document.toJson();
+}
+
+void DataFlowModel::loadFromJson(QJsonObject const& json) {
+  suspendPropagation();
+
+  try {
+    // saved id -> id in this model, they differ when the saved one is taken
+    QHash<QString, QString> ids;
+
+    QJsonArray nodesJsonArray = json["nodes"].toArray();
+    for (int i = 0; i < nodesJsonArray.size(); ++i) {
+      QJsonObject nodeJson = nodesJsonArray[i].toObject();
+
+      Node& node = restoreNode(nodeJson);
+      ids[nodeJson["id"].toString()] = node.id().toString();
+    }
+
+    QJsonArray connectionJsonArray = json["connections"].toArray();
+    for (int i = 0; i < connectionJsonArray.size(); ++i) {
+      QJsonObject connectionJson = connectionJsonArray[i].toObject();
+
+      QString inId  = connectionJson["in_id"].toString();
+      QString outId = connectionJson["out_id"].toString();
+      connectionJson["in_id"]  = ids.value(inId, inId);
+      connectionJson["out_id"] = ids.value(outId, outId);
+
+      restoreConnection(connectionJson);
+    }
+  } catch (...) {
+    resumePropagation();
+    throw;
+  }
+
+  resumePropagation();
+}
+
+void DataFlowModel::loadFromBinary(QByteArray const& data) {
+  QBuffer buffer;
+  buffer.setData(data);
+  buffer.open(QIODevice::ReadOnly);
+
+  loadFromBinary(buffer);
+}
+
+void DataFlowModel::loadFromBinary(QIODevice& device) {
+  FlowBinaryFormat::Reader reader(device);
+
+  reader.readMagic();
+
+  quint64 version = reader.readVarint();
+  if (version > FlowBinaryFormat::CurrentVersion)
+    throw std::logic_error("Binary flow version " + std::to_string(version) +
+                           " is newer than this library");
+
+  suspendPropagation();
+
+  try {
+    QStringList names;
+
+    quint64 nameCount = reader.readVarint();
+    for (quint64 i = 0; i < nameCount; ++i) {
+      names.append(reader.readString());
+    }
+
+    // the nodes in file order, connections refer to them by position
+    std::vector<Node*> nodes;
+
+    quint64 nodeCount = reader.readVarint();
+    for (quint64 i = 0; i < nodeCount; ++i) {
+      QUuid id = reader.readUuid();
+      quint64 nameIndex = reader.readVarint();
+      double x = reader.readDouble();
+      double y = reader.readDouble();
+      QByteArray payload = reader.readBytes();
+
+      if (nameIndex >= static_cast<quint64>(names.size()))
+        throw std::logic_error("Malformed binary flow: bad model name index");
+
+      QString const& modelName = names[static_cast<int>(nameIndex)];
+
+      auto model = _registry->create(modelName);
+
+      if (!model)
+        throw std::logic_error(std::string("No registered model with name ") +
+                               modelName.toLocal8Bit().data());
+
+      if (id.isNull() || _nodes.find(id) != _nodes.end()) {
+        id = QUuid::createUuid();
+      }
+
+      Node& node = addNode(std::move(model), id);
+      node.setPosition(QPointF(x, y));
+
+      QJsonObject modelJson;
+      if (!payload.isEmpty()) modelJson = QJsonDocument::fromJson(payload).object();
+      modelJson["name"] = modelName;
+      node.nodeDataModel()->restore(modelJson);
+
+      nodes.push_back(&node);
+
+      if (nodes.size() % LoadProgressInterval == 1) reportLoadProgress(device);
+    }
+
+    quint64 connectionCount = reader.readVarint();
+    for (quint64 i = 0; i < connectionCount; ++i) {
+      quint64 outNode = reader.readVarint();
+      quint64 outPort = reader.readVarint();
+      quint64 inNode  = reader.readVarint();
+      quint64 inPort  = reader.readVarint();
+
+      if (outNode >= nodes.size() || inNode >= nodes.size())
+        throw std::logic_error("Malformed binary flow: bad node index");
+
+      Node& out = *nodes[outNode];
+      Node& in  = *nodes[inNode];
+
+      if (outPort >= out.nodeDataModel()->nPorts(PortType::Out) ||
+          inPort >= in.nodeDataModel()->nPorts(PortType::In))
+        throw std::logic_error("Malformed binary flow: bad port index");
+
+      ConnectionID connID;
+      connID.lNodeID = out.id();
+      connID.rNodeID = in.id();
+      connID.lPortID = static_cast<PortIndex>(outPort);
+      connID.rPortID = static_cast<PortIndex>(inPort);
+
+      if (_connections.find(connID) != _connections.end())
+        throw std::logic_error("Malformed binary flow: duplicate connection");
+
+      addConnection(nodeIndex(out.id()), connID.lPortID,
+                    nodeIndex(in.id()), connID.rPortID);
+
+      if (i % LoadProgressInterval == 0) reportLoadProgress(device);
+    }
+  } catch (...) {
+    resumePropagation();
+    throw;
+  }
+
+  reportLoadProgress(device);
+
+  resumePropagation();
+}
+
+void DataFlowModel::loadFromMemory(QByteArray const& data) {
+  if (FlowBinaryFormat::isBinary(data)) {
+    loadFromBinary(data);
+    return;
+  }
+
+  loadFromJson(QJsonDocument::fromJson(data).object());
+}
+
+void DataFlowModel::loadFromDevice(QIODevice& device) {
+  if (FlowBinaryFormat::isBinary(device)) {
+    loadFromBinary(device);
+    return;
+  }
+
+  loadFromJsonDevice(device);
+}
+
+void DataFlowModel::loadFromJsonDevice(QIODevice& device) {
+  // QJsonObject sorts its keys, so saved connections come before the
+  // nodes they refer to and wait for them here
+  struct SavedConnection {
+    QUuid     outId;
+    PortIndex outPort;
+    QUuid     inId;
+    PortIndex inPort;
+  };
+  std::vector<SavedConnection> connections;
+
+  // saved id -> id in this model, only for the ones that differ
+  QHash<QUuid, QUuid> ids;
+
+  std::size_t records = 0;
+
+  suspendPropagation();
+
+  try {
+    JsonRecordReader reader(device);
+
+    reader.read([&](QByteArray const& key, QByteArray const& record) {
+      QJsonObject json = QJsonDocument::fromJson(record).object();
+
+      if (key == "nodes") {
+        QUuid savedId(json["id"].toString());
+
+        Node& node = restoreNode(json);
+        if (node.id() != savedId) ids.insert(savedId, node.id());
+      } else if (key == "connections") {
+        connections.push_back({QUuid(json["out_id"].toString()), json["out_index"].toInt(),
+                               QUuid(json["in_id"].toString()), json["in_index"].toInt()});
+      }
+
+      if (++records % LoadProgressInterval == 1) reportLoadProgress(device);
+    });
+
+    for (const auto& conn : connections) {
+      NodeIndex nodeOut = nodeIndex(ids.value(conn.outId, conn.outId));
+      NodeIndex nodeIn  = nodeIndex(ids.value(conn.inId, conn.inId));
+
+      if (nodeOut.isValid() && nodeIn.isValid())
+        addConnection(nodeOut, conn.outPort, nodeIn, conn.inPort);
+    }
+  } catch (...) {
+    resumePropagation();
+    throw;
+  }
+
+  reportLoadProgress(device);
+
+  resumePropagation();
+}
+
+void DataFlowModel::reportLoadProgress(QIODevice& device) {
+  emit loadProgress(device.pos(), device.isSequential() ? -1 : device.size());
+}
+
+Node& DataFlowModel::restoreNode(QJsonObject const& nodeJson) {
+  QString modelName = nodeJson["model"].toObject()["name"].toString();
+
+  auto model = _registry->create(modelName);
+
+  if (!model)
+    throw std::logic_error(std::string("No registered model with name ") +
+                           modelName.toLocal8Bit().data());
+
+  QUuid id(nodeJson["id"].toString());
+  if (id.isNull() || _nodes.find(id) != _nodes.end()) {
+    id = QUuid::createUuid();
+  }
+
+  Node& node = addNode(std::move(model), id);
+
+  // Node::restore takes the id from the json as well
+  QJsonObject json = nodeJson;
+  json["id"] = id.toString();
+  node.restore(json);
+
+  return node;
+}
+
+bool DataFlowModel::restoreConnection(QJsonObject const& connectionJson) {
+  NodeIndex nodeIn  = nodeIndex(QUuid(connectionJson["in_id"].toString()));
+  NodeIndex nodeOut = nodeIndex(QUuid(connectionJson["out_id"].toString()));
+
+  if (!nodeIn.isValid() || !nodeOut.isValid()) return false;
+
+  PortIndex portIndexIn  = connectionJson["in_index"].toInt();
+  PortIndex portIndexOut = connectionJson["out_index"].toInt();
+
+  return addConnection(nodeOut, portIndexOut, nodeIn, portIndexIn);
+}
+
+void DataFlowModel::propagateDirtyOutputs() {
+  // a throwing setInData abandons the pass, the next update starts a new one
+  struct PassGuard {
+    DataFlowModel& model;
+
+    ~PassGuard() {
+      model._propagating = false;
+      model._dirtyQueue = decltype(model._dirtyQueue)();
+      model._dirtyOutputs.clear();
+    }
+  } guard{*this};
+
+  _propagating = true;
+
+  std::size_t rankedGeneration = 0;
+
+  auto rankDirtyNodes = [&] {
+    _dirtyQueue = decltype(_dirtyQueue)();
+
+    for (const auto& pair : _dirtyOutputs) {
+      _dirtyQueue.emplace(topologicalRank(pair.first), pair.first);
+    }
+
+    rankedGeneration = _topologicalOrderGeneration;
+  };
+
+  rankDirtyNodes();
+
+  // nodes become dirty only downstream of the node being delivered, so
+  // popping by rank delivers every output once per pass
+  std::unordered_set<Node*> cyclicDelivered;
+
+  while (!_dirtyQueue.empty()) {
+    // setInData added or removed connections, the queued ranks are stale;
+    // a node marked dirty since may already have ordered the graph again
+    if (!_topologicalOrderValid || _topologicalOrderGeneration != rankedGeneration) rankDirtyNodes();
+
+    RankedNode top = _dirtyQueue.top();
+    _dirtyQueue.pop();
+
+    Node* node = top.second;
+
+    auto iter = _dirtyOutputs.find(node);
+    if (iter == _dirtyOutputs.end()) continue;
+
+    auto ports = std::move(iter->second);
+    _dirtyOutputs.erase(iter);
+
+    // a node on a cycle would dirty itself forever
+    if (top.first == CyclicRank && !cyclicDelivered.insert(node).second) continue;
+
+    for (PortIndex portIndex : ports) {
+      auto data = node->nodeDataModel()->outData(portIndex);
+
+      // copy, setInData may add or remove connections
+      auto connections = node->connections(PortType::Out, portIndex);
+      for (Connection* conn : connections) {
+        conn->propagateData(data);
+      }
+    }
+  }
+}
+
+std::vector<Node*> const& DataFlowModel::topologicalOrder() const {
+  if (!_topologicalOrderValid) updateTopologicalOrder();
+
+  return _topologicalOrder;
+}
+
+bool DataFlowModel::hasCycle() const {
+  return topologicalOrder().size() != _nodes.size();
+}
+
+void DataFlowModel::invalidateTopologicalOrder() {
+  _topologicalOrderValid = false;
+
+  // setInData of a node the running pass computes edited the graph
+  if (_executor) _executor->graphChanged();
+}
+
+void DataFlowModel::updateTopologicalOrder() const {
+  _topologicalOrder.clear();
+  _topologicalOrder.reserve(_nodes.size());
+  _topologicalRank.clear();
+  _topologicalRank.reserve(_nodes.size());
+
+  // Kahn's algorithm: count incoming connections, peel off nodes without any
+  std::unordered_map<Node*, std::size_t> inDegree;
+  std::vector<Node*> ready;
+
+  for (const auto& pair : _nodes) {
+    Node* node = pair.second.get();
+
+    std::size_t degree = 0;
+    auto nIn = node->nodeDataModel()->nPorts(PortType::In);
+    for (PortIndex portIndex = 0; portIndex < static_cast<PortIndex>(nIn); ++portIndex) {
+      degree += node->connections(PortType::In, portIndex).size();
+    }
+
+    if (degree == 0) {
+      ready.push_back(node);
+    } else {
+      inDegree[node] = degree;
+    }
+  }
+
+  while (!ready.empty()) {
+    Node* node = ready.back();
+    ready.pop_back();
+
+    _topologicalRank[node] = _topologicalOrder.size();
+    _topologicalOrder.push_back(node);
+
+    auto nOut = node->nodeDataModel()->nPorts(PortType::Out);
+    for (PortIndex portIndex = 0; portIndex < static_cast<PortIndex>(nOut); ++portIndex) {
+      for (Connection* conn : node->connections(PortType::Out, portIndex)) {
+        Node* downstream = conn->getNode(PortType::In);
+        if (--inDegree[downstream] == 0) ready.push_back(downstream);
+      }
+    }
+  }
+
+  // whatever is left in inDegree with a non-zero count sits on a cycle
+  _topologicalOrderValid = true;
+  ++_topologicalOrderGeneration;
+}
+
+std::size_t DataFlowModel::topologicalRank(Node* node) const {
+  if (!_topologicalOrderValid) updateTopologicalOrder();
+
+  auto iter = _topologicalRank.find(node);
+  if (iter == _topologicalRank.end()) return CyclicRank;
+
+  return iter->second;
+}
+
 void DataFlowModel::nodeDoubleClicked(NodeIndex const& index, QPoint const& pos) {
   emit nodeDoubleClickedSignal(*_nodes[index.id()]);
 
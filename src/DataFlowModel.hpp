@@ -7,13 +7,29 @@
 #include "Connection.hpp"
 #include "QUuidStdHash.hpp"
 
+#include <functional>
 #include <unordered_map>
+#include <vector>
 #include <memory>
+#include <queue>
+#include <set>
 
 #include <QUuid>
+#include <QByteArray>
+#include <QIODevice>
+#include <QJsonObject>
 
 namespace QtNodes {
 
+class DataFlowExecutor;
+
+enum class SerializationFormat
+{
+  Json,
+  /// Versioned and compact, see FlowBinaryFormat
+  Binary
+};
+
 // default model class
 class DataFlowModel : public FlowSceneModel {
   Q_OBJECT
@@ -21,10 +37,14 @@ public:
 
   DataFlowModel(std::shared_ptr<DataModelRegistry> reg);
 
+  ~DataFlowModel();
+
   // FlowSceneModel read interface
   QStringList modelRegistry() const override;
   QString nodeTypeCategory(QString const& /*name*/) const override;
   QString converterNode(NodeDataType const& /*lhs*/, NodeDataType const& ) const override;
+  QStringList converterNodes(NodeDataType const& lhs, NodeDataType const& rhs) const override;
+  bool canConvert(NodeDataType const& lhs, NodeDataType const& rhs) const override;
   QList<QUuid> nodeUUids() const override;
   NodeIndex nodeIndex(const QUuid& ID) const override;
   QString nodeTypeIdentifier(NodeIndex const& index) const override;
@@ -35,20 +55,83 @@ public:
   NodeValidationState nodeValidationState(NodeIndex const& index) const override;
   QString nodeValidationMessage(NodeIndex const& index) const override;
   NodePainterDelegate* nodePainterDelegate(NodeIndex const& index) const override;
+  NodeStyle nodeStyle(NodeIndex const& index) const override;
+  NodeStyleHandle nodeStyleHandle(NodeIndex const& index) const override;
   unsigned int nodePortCount(NodeIndex const& index, PortType portType) const override;
   QString nodePortCaption(NodeIndex const& index, PortType portType, PortIndex pIndex) const override;
   NodeDataType nodePortDataType(NodeIndex const& index, PortType portType, PortIndex pIndex) const override;
   ConnectionPolicy nodePortConnectionPolicy(NodeIndex const& index, PortType portType, PortIndex pIndex) const override;
   std::vector<std::pair<NodeIndex, PortIndex>> nodePortConnections(NodeIndex const& index, PortType portType, PortIndex id) const override;
+  void visitNodePortConnections(NodeIndex const& index, PortType portType, PortIndex id, ConnectionVisitor visitor) const override;
 
   // FlowSceneModel write interface
   bool removeConnection(NodeIndex const& leftNode, PortIndex leftPortID, NodeIndex const& rightNode, PortIndex rightPortID) override;
   bool addConnection(NodeIndex const& leftNode, PortIndex leftPortID, NodeIndex const& rightNode, PortIndex rightPortID) override;
   bool removeNode(NodeIndex const& index) override;
   QUuid addNode(const QString& typeID, QPointF const& location) override;
-  Node& addNode(std::unique_ptr<NodeDataModel>&& model);
+  /// A null `id` gets a fresh one
+  Node& addNode(std::unique_ptr<NodeDataModel>&& model, QUuid const& id = QUuid());
   bool moveNode(NodeIndex const& index, QPointF newLocation) override;
 
+  // data propagation
+
+  /// Marks an output port as changed. Outside of a propagation pass this
+  /// starts one; inside a pass the port is only queued, so every output is
+  /// delivered downstream once per pass, in dependent order.
+  void markOutputDirty(Node& node, PortIndex portIndex);
+
+  /// Opt in to running propagation passes on a thread pool, see
+  /// DataFlowExecutor. Off by default.
+  void setParallelExecution(bool enabled);
+  bool parallelExecution() const;
+
+  /// Delivers everything the running parallel pass still has pending.
+  /// Graph mutations call this before touching connections.
+  void waitForPropagation();
+
+  /// While suspended, updates are only recorded and new connections don't
+  /// pull data; the outermost resume runs one pass over all of it.
+  void suspendPropagation();
+  void resumePropagation();
+
+  // serialization
+
+  /// Same format as DataFlowScene::saveToMemory()
+  QJsonObject saveToJson() const;
+  QByteArray saveToBinary() const;
+  QByteArray saveToMemory(SerializationFormat format = SerializationFormat::Json) const;
+
+  /// Adds the nodes and connections of a saved graph. Saved ids are kept
+  /// unless they are already taken. Data propagates once, after everything
+  /// is restored.
+  void loadFromJson(QJsonObject const& json);
+  /// Throws std::logic_error on malformed data
+  void loadFromBinary(QByteArray const& data);
+  void loadFromBinary(QIODevice& device);
+  /// Either format, told apart by the binary magic
+  void loadFromMemory(QByteArray const& data);
+
+  /// Streams either format from `device`: nodes and connections are
+  /// created as their records are read, so memory stays at one record plus
+  /// the graph no matter how large the file is. Emits loadProgress() as it
+  /// goes. Throws std::logic_error on malformed data.
+  void loadFromDevice(QIODevice& device);
+
+  /// Throws std::logic_error if the model name isn't registered
+  Node& restoreNode(QJsonObject const& nodeJson);
+  bool restoreConnection(QJsonObject const& connectionJson);
+
+  // graph order
+
+  /// Every node that is not on a cycle, each after all of its upstream
+  /// nodes. Computed in O(V+E) and cached until a node or connection is
+  /// added or removed.
+  std::vector<Node*> const& topologicalOrder() const;
+
+  /// True if some nodes depend on themselves and are missing from
+  /// topologicalOrder().
+  bool hasCycle() const;
+
   // notifications
   void nodeDoubleClicked(NodeIndex const& index, QPoint const& pos) override;
   void connectionHovered(NodeIndex const& lhs, PortIndex lPortIndex, NodeIndex const& rhs, PortIndex rPortIndex, QPoint const& pos, bool entered) override;
@@ -56,6 +139,9 @@ public:
 
 signals:
 
+  /// `bytesTotal` is -1 for sequential devices
+  void loadProgress(qint64 bytesRead, qint64 bytesTotal);
+
   void nodeDoubleClickedSignal(Node& node);
   void connectionHoveredEnteredSignal(Connection& c, QPoint screenPos);
   void connectionHoveredLeftSignal(Connection& c, QPoint screenPos);
@@ -71,5 +157,40 @@ public:
   std::unordered_map<QUuid, UniqueNode>              _nodes;
   std::shared_ptr<DataModelRegistry>                 _registry;
 
+private:
+
+  void propagateDirtyOutputs();
+
+  void loadFromJsonDevice(QIODevice& device);
+
+  void reportLoadProgress(QIODevice& device);
+
+  void startParallelPass();
+
+  void invalidateTopologicalOrder();
+
+  void updateTopologicalOrder() const;
+
+  /// Position in topologicalOrder(), nodes on a cycle rank last
+  std::size_t topologicalRank(Node* node) const;
+
+  std::unordered_map<Node*, std::set<PortIndex>> _dirtyOutputs;
+  bool                                           _propagating = false;
+  int                                            _propagationSuspended = 0;
+
+  // dirty nodes of the running serial pass, lowest rank first
+  using RankedNode = std::pair<std::size_t, Node*>;
+  std::priority_queue<RankedNode, std::vector<RankedNode>, std::greater<RankedNode>> _dirtyQueue;
+
+  mutable std::vector<Node*>                     _topologicalOrder;
+  mutable std::unordered_map<Node*, std::size_t> _topologicalRank;
+  mutable bool                                   _topologicalOrderValid = false;
+
+  // bumped by every updateTopologicalOrder(), ranks taken under an older
+  // one are stale
+  mutable std::size_t _topologicalOrderGeneration = 0;
+
+  DataFlowExecutor* _executor = nullptr;
+
 };
 } // namespace QtNodes
\ No newline at end of file
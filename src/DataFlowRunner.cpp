@@ -0,0 +1,84 @@
+#include "DataFlowRunner.hpp"
+
+#include <QtCore/QFile>
+
+#include "Node.hpp"
+#include "NodeDataModel.hpp"
+#include "DataModelRegistry.hpp"
+
+namespace QtNodes {
+
+DataFlowRunner::
+DataFlowRunner(std::shared_ptr<DataModelRegistry> registry)
+  : _model(std::move(registry))
+{}
+
+
+void
+DataFlowRunner::
+loadFromMemory(QByteArray const& data)
+{
+  _model.loadFromMemory(data);
+
+  _model.waitForPropagation();
+}
+
+
+bool
+DataFlowRunner::
+loadFromFile(QString const& fileName)
+{
+  QFile file(fileName);
+
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+
+  _model.loadFromDevice(file);
+
+  _model.waitForPropagation();
+
+  return true;
+}
+
+
+void
+DataFlowRunner::
+run()
+{
+  _model.suspendPropagation();
+
+  for (Node* node : _model.topologicalOrder())
+  {
+    auto nOut = node->nodeDataModel()->nPorts(PortType::Out);
+
+    for (PortIndex portIndex = 0; portIndex < static_cast<PortIndex>(nOut); ++portIndex)
+    {
+      _model.markOutputDirty(*node, portIndex);
+    }
+  }
+
+  _model.resumePropagation();
+
+  _model.waitForPropagation();
+}
+
+
+std::shared_ptr<NodeData>
+DataFlowRunner::
+outData(QUuid const& nodeId, PortIndex portIndex) const
+{
+  auto iter = _model._nodes.find(nodeId);
+
+  if (iter == _model._nodes.end())
+    return nullptr;
+
+  auto model = iter->second->nodeDataModel();
+
+  // models index their ports without checking
+  if (portIndex < 0 || portIndex >= static_cast<PortIndex>(model->nPorts(PortType::Out)))
+    return nullptr;
+
+  return model->outData(portIndex);
+}
+
+} // namespace QtNodes
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <memory>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+#include <QtCore/QUuid>
+
+#include "Export.hpp"
+#include "PortType.hpp"
+#include "DataFlowModel.hpp"
+
+namespace QtNodes
+{
+
+class DataModelRegistry;
+class NodeData;
+
+/// Loads and evaluates saved flows without a FlowScene or FlowView.
+///
+/// Only the DataFlowModel is built, no QGraphicsItem is ever created, so
+/// batch jobs pay for the nodes' data and nothing else. Models that build
+/// an embedded widget in their constructor still need a QApplication;
+/// widget-free models run under a QCoreApplication.
+class NODE_EDITOR_PUBLIC DataFlowRunner
+{
+public:
+
+  DataFlowRunner(std::shared_ptr<DataModelRegistry> registry);
+
+  DataFlowRunner(DataFlowRunner const&) = delete;
+
+  DataFlowRunner&
+  operator=(DataFlowRunner const&) = delete;
+
+public:
+
+  DataFlowModel&
+  model() { return _model; }
+
+  DataFlowModel const&
+  model() const { return _model; }
+
+  /// Accepts anything DataFlowScene::loadFromMemory() does. Throws
+  /// std::logic_error for unregistered models.
+  void
+  loadFromMemory(QByteArray const& data);
+
+  /// Returns false if the file can't be read
+  bool
+  loadFromFile(QString const& fileName);
+
+  /// Pushes every output through the graph once, in dependent order,
+  /// and returns when all of it has been delivered.
+  void
+  run();
+
+  /// Null if the node or the port doesn't exist, or there is no data on it
+  std::shared_ptr<NodeData>
+  outData(QUuid const& nodeId, PortIndex portIndex) const;
+
+private:
+
+  DataFlowModel _model;
+};
+}
@@ -5,6 +5,7 @@
 #include <QFileDialog>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QDebug>
 
 namespace QtNodes {
 
@@ -51,7 +52,8 @@ DataFlowScene::
 createConnection(Node& nodeIn,
   PortIndex portIndexIn, Node& nodeOut, PortIndex portIndexOut) 
 {
-  _dataFlowModel->addConnection(_dataFlowModel->nodeIndex(nodeOut.id()), portIndexOut, _dataFlowModel->nodeIndex(nodeIn.id()), portIndexIn);
+  if (!_dataFlowModel->addConnection(_dataFlowModel->nodeIndex(nodeOut.id()), portIndexOut, _dataFlowModel->nodeIndex(nodeIn.id()), portIndexIn))
+    return nullptr;
 
   ConnectionID id;
   id.lNodeID = nodeOut.id();
@@ -59,32 +61,33 @@ createConnection(Node& nodeIn,
   id.lPortID = portIndexOut;
   id.rPortID = portIndexIn;
 
-  return _dataFlowModel->_connections[id];
+  // operator[] would leave a null connection behind for a missing id
+  auto iter = _dataFlowModel->_connections.find(id);
+  if (iter == _dataFlowModel->_connections.end())
+    return nullptr;
+
+  return iter->second;
 }
 
 std::shared_ptr<Connection>
 DataFlowScene::
 restoreConnection(QJsonObject const &connectionJson)
 {
-  QUuid nodeInId  = QUuid(connectionJson["in_id"].toString());
-  QUuid nodeOutId = QUuid(connectionJson["out_id"].toString());
+  if (!_dataFlowModel->restoreConnection(connectionJson))
+    return nullptr;
 
-  PortIndex portIndexIn  = connectionJson["in_index"].toInt();
-  PortIndex portIndexOut = connectionJson["out_index"].toInt();
+  ConnectionID connId;
+  connId.lNodeID = QUuid(connectionJson["out_id"].toString());
+  connId.rNodeID = QUuid(connectionJson["in_id"].toString());
 
+  connId.lPortID = connectionJson["out_index"].toInt();
+  connId.rPortID = connectionJson["in_index"].toInt();
 
-  ConnectionID connId;
-  connId.lNodeID = nodeOutId;
-  connId.rNodeID = nodeInId;
-  
-  connId.lPortID = portIndexOut;
-  connId.rPortID = portIndexIn;
-  
-  if (!_dataFlowModel->addConnection(_dataFlowModel->nodeIndex(nodeOutId), connId.lPortID, _dataFlowModel->nodeIndex(nodeInId), connId.rPortID)) 
+  auto iter = _dataFlowModel->_connections.find(connId);
+  if (iter == _dataFlowModel->_connections.end())
     return nullptr;
 
-  return _dataFlowModel->_connections[connId];
-  
+  return iter->second;
 }
 
 void
@@ -104,18 +107,7 @@ Node&
 DataFlowScene::
 restoreNode(QJsonObject const& nodeJson)
 {
-  QString modelName = nodeJson["model"].toObject()["name"].toString();
-
-  auto uuid = _dataFlowModel->addNode(modelName, {});
-  
-  if (uuid.isNull())
-    throw std::logic_error(std::string("No registered model with name ") +
-                           modelName.toLocal8Bit().data());
-
-  auto& node = *_dataFlowModel->_nodes[uuid];
-  node.restore(nodeJson);
-
-  return node;
+  return _dataFlowModel->restoreNode(nodeJson);
 }
 
 void 
@@ -168,73 +160,14 @@ setNodePosition(Node& node, const QPointF& pos) const {
 void
 DataFlowScene::
 iterateOverNodeDataDependentOrder(std::function<void(NodeDataModel*)> visitor) {
-  std::set<QUuid> visitedNodesSet;
-
-  //A leaf node is a node with no input ports, or all possible input ports empty
-  auto isNodeLeaf =
-    [](NodeGraphicsObject const &node, NodeDataModel const &model)
-    {
-      for (size_t i = 0; i < model.nPorts(PortType::In); ++i)
-      {
-        auto connections = node.nodeState().connections(PortType::In, i);
-        if (!connections.empty())
-        {
-          return false;
-        }
-      }
-
-      return true;
-    };
-
-  //Iterate over "leaf" nodes
-  for (auto const &_node : _dataFlowModel->_nodes)
+  if (_dataFlowModel->hasCycle())
   {
-    auto const &node = *_node.second;
-    auto model       = node.nodeDataModel();
-
-    if (isNodeLeaf(*nodeGraphicsObject(node.id()), *model))
-    {
-      visitor(model);
-      visitedNodesSet.insert(node.id());
-    }
+    qWarning() << "DataFlowScene: skipping nodes that depend on themselves";
   }
 
-  auto areNodeInputsVisitedBefore =
-    [&](NodeGraphicsObject const &node, NodeDataModel const &model)
-    {
-      for (size_t i = 0; i < model.nPorts(PortType::In); ++i)
-      {
-        auto connections = node.nodeState().connections(PortType::In, i);
-
-        for (auto& conn : connections)
-        {
-          if (visitedNodesSet.find(conn->node(PortType::Out).id()) == visitedNodesSet.end())
-          {
-            return false;
-          }
-        }
-      }
-
-      return true;
-    };
-
-  //Iterate over dependent nodes
-  while (_dataFlowModel->_nodes.size() != visitedNodesSet.size())
+  for (Node* node : _dataFlowModel->topologicalOrder())
   {
-    for (auto const &_node : _dataFlowModel->_nodes)
-    {
-      auto const &node = _node.second;
-      if (visitedNodesSet.find(node->id()) != visitedNodesSet.end())
-        continue;
-
-      auto model = node->nodeDataModel();
-
-      if (areNodeInputsVisitedBefore(*nodeGraphicsObject(node->id()), *model))
-      {
-        visitor(model);
-        visitedNodesSet.insert(node->id());
-      }
-    }
+    visitor(node->nodeDataModel());
   }
 }
 
@@ -308,7 +241,7 @@ save() const
     QFile file(fileName);
     if (file.open(QIODevice::WriteOnly))
     {
-      file.write(saveToMemory());
+      file.write(saveToMemory(_saveFormat));
     }
   }
 }
@@ -336,45 +269,29 @@ load()
   if (!file.open(QIODevice::ReadOnly))
     return;
 
-  QByteArray wholeFile = file.readAll();
-
-  loadFromMemory(wholeFile);
+  loadFromDevice(file);
 }
 
 
 QByteArray
 DataFlowScene::
-saveToMemory() const
+saveToMemory(SerializationFormat format) const
 {
-  QJsonObject sceneJson;
-
-  QJsonArray nodesJsonArray;
-
-  for (auto const & pair : _dataFlowModel->_nodes)
-  {
-    auto const &node = pair.second;
-
-    nodesJsonArray.append(node->save());
-  }
-
-  sceneJson["nodes"] = nodesJsonArray;
-
-  QJsonArray connectionJsonArray;
-  for (auto const & pair : _dataFlowModel->_connections)
-  {
-    auto const &connection = pair.second;
-
-    QJsonObject connectionJson = connection->save();
-
-    if (!connectionJson.isEmpty())
-      connectionJsonArray.append(connectionJson);
-  }
-
-  sceneJson["connections"] = connectionJsonArray;
+  return _dataFlowModel->saveToMemory(format);
+}
 
-  QJsonDocument document(sceneJson);
+SerializationFormat
+DataFlowScene::
+saveFormat() const
+{
+  return _saveFormat;
+}
 
-  return document.toJson();
+void
+DataFlowScene::
+setSaveFormat(SerializationFormat format)
+{
+  _saveFormat = format;
 }
 
 QByteArray
@@ -417,21 +334,32 @@ void
 DataFlowScene::
 loadFromMemory(const QByteArray& data)
 {
-  QJsonObject const jsonDocument = QJsonDocument::fromJson(data).object();
-
-  QJsonArray nodesJsonArray = jsonDocument["nodes"].toArray();
+  beginDeferredUpdates();
 
-  for (int i = 0; i < nodesJsonArray.size(); ++i)
-  {
-    restoreNode(nodesJsonArray[i].toObject());
+  try {
+    _dataFlowModel->loadFromMemory(data);
+  } catch (...) {
+    endDeferredUpdates();
+    throw;
   }
 
-  QJsonArray connectionJsonArray = jsonDocument["connections"].toArray();
+  endDeferredUpdates();
+}
 
-  for (int i = 0; i < connectionJsonArray.size(); ++i)
-  {
-    restoreConnection(connectionJsonArray[i].toObject());
+void
+DataFlowScene::
+loadFromDevice(QIODevice& device)
+{
+  beginDeferredUpdates();
+
+  try {
+    _dataFlowModel->loadFromDevice(device);
+  } catch (...) {
+    endDeferredUpdates();
+    throw;
   }
+
+  endDeferredUpdates();
 }
 
 } // namespace QtNodes
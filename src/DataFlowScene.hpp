@@ -27,11 +27,13 @@ public:
   DataFlowScene(std::shared_ptr<DataModelRegistry> registry =
               std::make_shared<DataModelRegistry>());
 
+  /// Null if the model rejects the connection, e.g. a duplicate
   std::shared_ptr<Connection>createConnection(Node& nodeIn,
                                               PortIndex portIndexIn,
                                               Node& nodeOut,
                                               PortIndex portIndexOut);
 
+  /// Null if the connection can't be restored
   std::shared_ptr<Connection>restoreConnection(QJsonObject const &connectionJson);
 
   void deleteConnection(Connection& connection);
@@ -69,16 +71,28 @@ public:
 
   void clearScene();
 
+  /// Writes saveFormat()
   void save() const;
 
+  /// Reads either format
   void load();
 
-  QByteArray saveToMemory() const;
+  QByteArray saveToMemory(SerializationFormat format = SerializationFormat::Json) const;
+
+  /// Format written by save(), JSON by default
+  SerializationFormat saveFormat() const;
+
+  void setSaveFormat(SerializationFormat format);
 
   QByteArray saveToMemory(int index) const;
 
+  /// Either format, told apart by the binary magic
   void loadFromMemory(const QByteArray& data);
 
+  /// Streams either format, see DataFlowModel::loadFromDevice(). Graphics
+  /// objects are created once everything is read.
+  void loadFromDevice(QIODevice& device);
+
 signals:
 
   void nodeCreated(Node &n);
@@ -104,6 +118,8 @@ private:
   
   DataFlowModel* _dataFlowModel;
 
+  SerializationFormat _saveFormat = SerializationFormat::Json;
+
 };
 
 } // namespace QtNodes
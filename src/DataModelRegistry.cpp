@@ -1,8 +1,12 @@
 #include "DataModelRegistry.hpp"
 
+#include <algorithm>
+
 #include <QtCore/QFile>
 #include <QtWidgets/QMessageBox>
 
+#include "ConnectionStyle.hpp"
+
 using QtNodes::DataModelRegistry;
 using QtNodes::NodeDataModel;
 
@@ -21,6 +25,21 @@ create(QString const &modelName)
 }
 
 
+std::unique_ptr<NodeDataModel>
+DataModelRegistry::
+create(Atom modelName)
+{
+  auto it = _registeredModelsByAtom.find(modelName);
+
+  if (it != _registeredModelsByAtom.end())
+  {
+    return it->second->clone();
+  }
+
+  return nullptr;
+}
+
+
 DataModelRegistry::RegisteredModelsMap const &
 DataModelRegistry::
 registeredModels() const
@@ -49,12 +68,139 @@ std::unique_ptr<NodeDataModel>
 DataModelRegistry::
 getTypeConverter(QString const &sourceTypeID, QString const &destTypeID) const
 {
-  auto typeConverterKey = std::make_pair(sourceTypeID, destTypeID);
-  auto converter = _registeredTypeConverters.find(typeConverterKey);
+  if (auto converter = typeConverter(sourceTypeID, destTypeID))
+  {
+    return converter->Model->clone();
+  }
+  return nullptr;
+}
+
+
+DataModelRegistry::TypeConverterItem const*
+DataModelRegistry::
+typeConverter(QString const &sourceTypeID, QString const &destTypeID) const
+{
+  auto converter = _registeredTypeConverters.find(std::make_pair(sourceTypeID, destTypeID));
 
   if (converter != _registeredTypeConverters.end())
   {
-    return converter->second->Model->clone();
+    return converter->second.get();
   }
   return nullptr;
-}
\ No newline at end of file
+}
+
+
+DataModelRegistry::TypeConverterChain const &
+DataModelRegistry::
+typeConverterChain(QString const &sourceTypeID, QString const &destTypeID) const
+{
+  return typeConverterChain(Atom(sourceTypeID), Atom(destTypeID));
+}
+
+
+DataModelRegistry::TypeConverterChain const &
+DataModelRegistry::
+typeConverterChain(Atom sourceType, Atom destType) const
+{
+  static TypeConverterChain const noChain;
+
+  if (!_converterChainsValid)
+    updateConverterChains();
+
+  auto chain = _converterChains.find(chainKey(sourceType, destType));
+
+  if (chain != _converterChains.end())
+  {
+    return chain->second;
+  }
+  return noChain;
+}
+
+
+void
+DataModelRegistry::
+updateConverterChains() const
+{
+  _converterChains.clear();
+
+  // outgoing converters of every type, by name so ties break the same way
+  // on every run
+  std::unordered_map<Atom, std::vector<TypeConverterItem const*>> outgoing;
+
+  for (auto const &pair : _registeredTypeConverters)
+  {
+    outgoing[pair.second->SourceType.atom()].push_back(pair.second.get());
+  }
+
+  for (auto &pair : outgoing)
+  {
+    std::sort(pair.second.begin(), pair.second.end(),
+              [](TypeConverterItem const* a, TypeConverterItem const* b)
+              {
+                return a->ModelName < b->ModelName;
+              });
+  }
+
+  // breadth first from every type that can be converted at all
+  for (auto const &source : outgoing)
+  {
+    // converter that first reached a type
+    std::unordered_map<Atom, TypeConverterItem const*> reachedBy;
+
+    std::vector<Atom> frontier{source.first};
+
+    for (std::size_t i = 0; i < frontier.size(); ++i)
+    {
+      auto edges = outgoing.find(frontier[i]);
+
+      if (edges == outgoing.end())
+        continue;
+
+      for (TypeConverterItem const* converter : edges->second)
+      {
+        Atom typeAtom = converter->DestinationType.atom();
+
+        if (typeAtom == source.first || reachedBy.count(typeAtom) != 0)
+          continue;
+
+        reachedBy[typeAtom] = converter;
+        frontier.push_back(typeAtom);
+      }
+    }
+
+    for (auto const &reached : reachedBy)
+    {
+      TypeConverterChain chain;
+
+      for (TypeConverterItem const* converter = reached.second;
+           ;
+           converter = reachedBy[converter->SourceType.atom()])
+      {
+        chain.push_back(converter);
+
+        if (converter->SourceType.atom() == source.first)
+          break;
+      }
+
+      std::reverse(chain.begin(), chain.end());
+
+      _converterChains[chainKey(source.first, reached.first)] = std::move(chain);
+    }
+  }
+
+  _converterChainsValid = true;
+}
+
+
+void
+DataModelRegistry::
+prepareDataTypes(NodeDataModel const &model)
+{
+  for (PortType portType : {PortType::In, PortType::Out})
+  {
+    for (unsigned int i = 0; i < model.nPorts(portType); ++i)
+    {
+      ConnectionStyle::dataTypeColor(model.dataType(portType, i).atom());
+    }
+  }
+}
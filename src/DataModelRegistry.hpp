@@ -3,11 +3,13 @@
 #include <unordered_map>
 #include <set>
 #include <memory>
+#include <vector>
 
 #include <QtCore/QString>
 
 #include "NodeDataModel.hpp"
 #include "Export.hpp"
+#include "Atom.hpp"
 #include "QStringStdHash.hpp"
 
 namespace QtNodes
@@ -27,13 +29,27 @@ public:
   struct TypeConverterItem
   {
     RegistryItemPtr Model{};
+    QString         ModelName{};
     NodeDataType    SourceType{};
     NodeDataType    DestinationType{};
   };
 
   using ConvertingTypesPair = std::pair<QString, QString>; //Source type ID, Destination type ID in this order
+
+  struct ConvertingTypesPairHash
+  {
+    std::size_t
+    operator()(ConvertingTypesPair const &pair) const
+    {
+      return qHash(pair.first, qHash(pair.second));
+    }
+  };
+
   using TypeConverterItemPtr = std::unique_ptr<TypeConverterItem>;
-  using RegisteredTypeConvertersMap = std::map<ConvertingTypesPair, TypeConverterItemPtr>;
+  using RegisteredTypeConvertersMap = std::unordered_map<ConvertingTypesPair, TypeConverterItemPtr, ConvertingTypesPairHash>;
+
+  /// Converters to apply one after the other, source type first
+  using TypeConverterChain = std::vector<TypeConverterItem const*>;
 
   DataModelRegistry()  = default;
   ~DataModelRegistry() = default;
@@ -59,6 +75,8 @@ public:
 
     if (_registeredModels.count(name) == 0)
     {
+      _registeredModelsByAtom[Atom(name)] = uniqueModel.get();
+      prepareDataTypes(*uniqueModel);
       _registeredModels[name] = std::move(uniqueModel);
       _categories.insert(category);
       _registeredModelsCategory[name] = category;
@@ -71,18 +89,21 @@ public:
       //Type converter node should have exactly one input and output ports, if thats not the case, we skip the registration.
       //If the input and output type is the same, we also skip registration, because thats not a typecast node.
       if (registeredModelRef->nPorts(PortType::In) != 1 || registeredModelRef->nPorts(PortType::Out) != 1 ||
-        registeredModelRef->dataType(PortType::In, 0).id == registeredModelRef->dataType(PortType::Out, 0).id)
+        registeredModelRef->dataType(PortType::In, 0).atom() == registeredModelRef->dataType(PortType::Out, 0).atom())
       {
         return;
       }
 
       TypeConverterItemPtr converter = std::make_unique<TypeConverterItem>();
       converter->Model = registeredModelRef->clone();
+      converter->ModelName = name;
       converter->SourceType = converter->Model->dataType(PortType::In, 0);
       converter->DestinationType = converter->Model->dataType(PortType::Out, 0);
 
       auto typeConverterKey = std::make_pair(converter->SourceType.id, converter->DestinationType.id);
-	  _registeredTypeConverters[typeConverterKey] = std::move(converter);
+      _registeredTypeConverters[typeConverterKey] = std::move(converter);
+
+      _converterChainsValid = false;
     }
   }
 
@@ -97,6 +118,10 @@ public:
   std::unique_ptr<NodeDataModel>
   create(QString const &modelName);
 
+  /// Same as above without hashing the name
+  std::unique_ptr<NodeDataModel>
+  create(Atom modelName);
+
   RegisteredModelsMap const &
   registeredModels() const;
   
@@ -106,15 +131,57 @@ public:
   CategoriesSet const &
   categories() const;
 
+  /// Instantiates the converter, prefer typeConverter() to just look
   std::unique_ptr<NodeDataModel>
   getTypeConverter(QString const &sourceTypeID,
                    QString const &destTypeID) const;
 
+  /// Name and types of the converter, nullptr if there is none. Nothing
+  /// is instantiated or allocated, so this is fine to call while painting.
+  TypeConverterItem const*
+  typeConverter(QString const &sourceTypeID,
+                QString const &destTypeID) const;
+
+  /// Shortest chain of converters from one type to another, empty if the
+  /// types can't be converted. Chains for all type pairs are computed on
+  /// the first call after a converter is registered, from then on this is
+  /// a single hash lookup. Ties go to the alphabetically first converter.
+  TypeConverterChain const &
+  typeConverterChain(QString const &sourceTypeID,
+                     QString const &destTypeID) const;
+
+  TypeConverterChain const &
+  typeConverterChain(Atom sourceType,
+                     Atom destType) const;
+
+private:
+
+  void
+  updateConverterChains() const;
+
+  /// Interns the port types of `model` and computes their colors up front
+  static
+  void
+  prepareDataTypes(NodeDataModel const &model);
+
+  static
+  quint64
+  chainKey(Atom sourceType, Atom destType)
+  { return (quint64(sourceType.value()) << 32) | destType.value(); }
+
 private:
 
   RegisteredModelsCategoryMap _registeredModelsCategory{};
   CategoriesSet _categories{};
   RegisteredModelsMap _registeredModels{};
   RegisteredTypeConvertersMap _registeredTypeConverters{};
+
+  std::unordered_map<Atom, NodeDataModel const*> _registeredModelsByAtom{};
+
+  // source atom in the high half, destination in the low one
+  using ConverterChainsMap = std::unordered_map<quint64, TypeConverterChain>;
+
+  mutable ConverterChainsMap _converterChains{};
+  mutable bool               _converterChainsValid = false;
 };
 }
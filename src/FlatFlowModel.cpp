@@ -0,0 +1,634 @@
+#include "FlatFlowModel.hpp"
+
+#include "DataModelRegistry.hpp"
+#include "NodeDataModel.hpp"
+#include "StyleCollection.hpp"
+
+namespace QtNodes {
+
+constexpr FlatFlowModel::Handle FlatFlowModel::InvalidHandle;
+
+FlatFlowModel::
+FlatFlowModel(std::shared_ptr<DataModelRegistry> registry)
+  : _registry(std::move(registry))
+{}
+
+
+FlatFlowModel::
+~FlatFlowModel() = default;
+
+
+QStringList
+FlatFlowModel::
+modelRegistry() const
+{
+  QStringList list;
+  for (auto const& item : _registry->registeredModels())
+  {
+    list << item.first;
+  }
+  return list;
+}
+
+
+QString
+FlatFlowModel::
+nodeTypeCategory(QString const& name) const
+{
+  auto const& categories = _registry->registeredModelsCategoryAssociation();
+
+  auto iter = categories.find(name);
+
+  if (iter != categories.end())
+  {
+    return iter->second;
+  }
+  return {};
+}
+
+
+QList<QUuid>
+FlatFlowModel::
+nodeUUids() const
+{
+  QList<QUuid> ret;
+  ret.reserve(static_cast<int>(_nodeIndex.size()));
+
+  for (auto const& node : _nodes)
+  {
+    if (node.model != nullptr)
+      ret.push_back(node.id);
+  }
+  return ret;
+}
+
+
+NodeIndex
+FlatFlowModel::
+nodeIndex(QUuid const& id) const
+{
+  return nodeIndex(nodeHandle(id));
+}
+
+
+QString
+FlatFlowModel::
+nodeTypeIdentifier(NodeIndex const& index) const
+{
+  return nodeSlot(index).model->name();
+}
+
+
+QString
+FlatFlowModel::
+nodeCaption(NodeIndex const& index) const
+{
+  auto model = nodeSlot(index).model;
+
+  if (!model->captionVisible())
+    return {};
+
+  return model->caption();
+}
+
+
+QPointF
+FlatFlowModel::
+nodeLocation(NodeIndex const& index) const
+{
+  return nodeSlot(index).position;
+}
+
+
+QWidget*
+FlatFlowModel::
+nodeWidget(NodeIndex const& /*index*/) const
+{
+  // the registered model's widget can't be shown by more than one node
+  return nullptr;
+}
+
+
+bool
+FlatFlowModel::
+nodeResizable(NodeIndex const& /*index*/) const
+{
+  return false;
+}
+
+
+NodeValidationState
+FlatFlowModel::
+nodeValidationState(NodeIndex const& index) const
+{
+  return nodeSlot(index).model->validationState();
+}
+
+
+QString
+FlatFlowModel::
+nodeValidationMessage(NodeIndex const& index) const
+{
+  return nodeSlot(index).model->validationMessage();
+}
+
+
+NodePainterDelegate*
+FlatFlowModel::
+nodePainterDelegate(NodeIndex const& index) const
+{
+  return nodeSlot(index).model->painterDelegate();
+}
+
+
+NodeStyle
+FlatFlowModel::
+nodeStyle(NodeIndex const& index) const
+{
+  return *nodeStyleHandle(index);
+}
+
+
+NodeStyleHandle
+FlatFlowModel::
+nodeStyleHandle(NodeIndex const& index) const
+{
+  auto const& style = nodeSlot(index).model->nodeStyleHandle();
+
+  return style ? style : StyleCollection::nodeStyleHandle();
+}
+
+
+unsigned int
+FlatFlowModel::
+nodePortCount(NodeIndex const& index, PortType portType) const
+{
+  return nodeSlot(index).portCount[side(portType)];
+}
+
+
+QString
+FlatFlowModel::
+nodePortCaption(NodeIndex const& index, PortType portType, PortIndex portIndex) const
+{
+  return nodeSlot(index).model->portCaption(portType, portIndex);
+}
+
+
+NodeDataType
+FlatFlowModel::
+nodePortDataType(NodeIndex const& index, PortType portType, PortIndex portIndex) const
+{
+  return nodeSlot(index).model->dataType(portType, portIndex);
+}
+
+
+ConnectionPolicy
+FlatFlowModel::
+nodePortConnectionPolicy(NodeIndex const& index, PortType portType, PortIndex portIndex) const
+{
+  if (portType == PortType::In)
+  {
+    return ConnectionPolicy::One;
+  }
+  return nodeSlot(index).model->portOutConnectionPolicy(portIndex);
+}
+
+
+std::vector<std::pair<NodeIndex, PortIndex>>
+FlatFlowModel::
+nodePortConnections(NodeIndex const& index, PortType portType, PortIndex portIndex) const
+{
+  std::vector<std::pair<NodeIndex, PortIndex>> ret;
+
+  forEachConnection(nodeHandle(index), portType, portIndex,
+                    [&](Handle node, PortIndex port)
+                    {
+                      ret.emplace_back(nodeIndex(node), port);
+                    });
+  return ret;
+}
+
+
+void
+FlatFlowModel::
+visitNodePortConnections(NodeIndex const& index, PortType portType, PortIndex portIndex, ConnectionVisitor visitor) const
+{
+  forEachConnection(nodeHandle(index), portType, portIndex,
+                    [&](Handle node, PortIndex port)
+                    {
+                      visitor(nodeIndex(node), port);
+                    });
+}
+
+
+bool
+FlatFlowModel::
+removeConnection(NodeIndex const& leftNode, PortIndex leftPortID, NodeIndex const& rightNode, PortIndex rightPortID)
+{
+  Handle connection = findConnection(nodeHandle(leftNode), leftPortID,
+                                     nodeHandle(rightNode), rightPortID);
+
+  if (connection == InvalidHandle)
+    return false;
+
+  emit connectionAboutToBeRemoved(leftNode, leftPortID, rightNode, rightPortID);
+
+  // traversals skip it from now on, the CSR arrays stay valid
+  _connections[connection].alive = false;
+  _removedConnections.push_back(connection);
+  --_connectionCount;
+
+  scheduleRebuild();
+
+  emit connectionRemoved(leftNode, leftPortID, rightNode, rightPortID);
+
+  return true;
+}
+
+
+bool
+FlatFlowModel::
+addConnection(NodeIndex const& leftNode, PortIndex leftPortID, NodeIndex const& rightNode, PortIndex rightPortID)
+{
+  if (!createConnection(nodeHandle(leftNode), leftPortID, nodeHandle(rightNode), rightPortID))
+    return false;
+
+  if (!deferToBatch()) emit connectionAdded(leftNode, leftPortID, rightNode, rightPortID);
+
+  return true;
+}
+
+
+bool
+FlatFlowModel::
+removeNode(NodeIndex const& index)
+{
+  Handle node = nodeHandle(index);
+
+  if (!isNode(node))
+    return false;
+
+  // the slot gets reused, connections left pointing at it would attach
+  // to whatever node comes next; removeNodeWithConnections() first
+  bool connected = false;
+
+  for (PortType portType : {PortType::In, PortType::Out})
+  {
+    for (PortIndex i = 0; i < static_cast<PortIndex>(_nodes[node].portCount[side(portType)]); ++i)
+    {
+      forEachConnection(node, portType, i, [&](Handle, PortIndex) { connected = true; });
+    }
+  }
+
+  if (connected)
+    return false;
+
+  emit nodeAboutToBeRemoved(index);
+
+  QUuid id = _nodes[node].id;
+
+  _nodeIndex.erase(id);
+  _nodes[node] = NodeSlot();
+  _freeNodes.push_back(node);
+
+  emit nodeRemoved(id);
+
+  return true;
+}
+
+
+QUuid
+FlatFlowModel::
+addNode(QString const& typeID, QPointF const& location)
+{
+  Handle node = createNode(typeID, location);
+
+  if (node == InvalidHandle)
+    return {};
+
+  QUuid id = _nodes[node].id;
+
+  if (!deferToBatch()) emit nodeAdded(id);
+
+  return id;
+}
+
+
+bool
+FlatFlowModel::
+moveNode(NodeIndex const& index, QPointF newLocation)
+{
+  Handle node = nodeHandle(index);
+
+  _nodes[node].position = newLocation;
+
+  if (!deferToBatch()) emit nodeMoved(index);
+
+  return true;
+}
+
+
+FlatFlowModel::Handle
+FlatFlowModel::
+nodeHandle(QUuid const& id) const
+{
+  auto iter = _nodeIndex.find(id);
+
+  if (iter == _nodeIndex.end())
+    return InvalidHandle;
+
+  return iter->second;
+}
+
+
+FlatFlowModel::Handle
+FlatFlowModel::
+nodeHandle(NodeIndex const& index) const
+{
+  Q_ASSERT(index.isValid());
+  Q_ASSERT(index.model() == this);
+
+  auto node = static_cast<Handle>(reinterpret_cast<quintptr>(index.internalPointer()));
+
+  // an index of a removed node whose slot was reused
+  Q_ASSERT(isNode(node) && _nodes[node].id == index.id());
+
+  return node;
+}
+
+
+NodeIndex
+FlatFlowModel::
+nodeIndex(Handle node) const
+{
+  if (!isNode(node))
+    return {};
+
+  return createIndex(_nodes[node].id, handlePointer(node));
+}
+
+
+FlatFlowModel::Handle
+FlatFlowModel::
+createNode(QString const& typeID, QPointF const& location, QUuid const& id)
+{
+  auto const& models = _registry->registeredModels();
+
+  auto model = models.find(typeID);
+
+  if (model == models.end())
+    return InvalidHandle;
+
+  QUuid nodeId = id.isNull() ? QUuid::createUuid() : id;
+
+  if (_nodeIndex.count(nodeId) != 0)
+    return InvalidHandle;
+
+  Handle node;
+  if (!_freeNodes.empty())
+  {
+    node = _freeNodes.back();
+    _freeNodes.pop_back();
+  }
+  else
+  {
+    node = static_cast<Handle>(_nodes.size());
+    _nodes.emplace_back();
+  }
+
+  NodeSlot& slot = _nodes[node];
+
+  slot.id       = nodeId;
+  slot.model    = model->second.get();
+  slot.position = location;
+
+  slot.portCount[side(PortType::In)]  = slot.model->nPorts(PortType::In);
+  slot.portCount[side(PortType::Out)] = slot.model->nPorts(PortType::Out);
+
+  _nodeIndex[nodeId] = node;
+
+  // fresh ports after all others, outside the CSR arrays; the ones of a
+  // reused slot stay unused until the next rebuild
+  for (int s = 0; s < 2; ++s)
+  {
+    Adjacency& adjacency = _adjacency[s];
+
+    if (adjacency.portBase.size() < _nodes.size())
+      adjacency.portBase.resize(_nodes.size());
+
+    adjacency.portBase[node] = static_cast<quint32>(adjacency.added.size());
+    adjacency.added.resize(adjacency.added.size() + slot.portCount[s], InvalidHandle);
+  }
+
+  return node;
+}
+
+
+bool
+FlatFlowModel::
+createConnection(Handle outNode, PortIndex outPort, Handle inNode, PortIndex inPort)
+{
+  if (!isNode(outNode) || !isNode(inNode))
+    return false;
+
+  if (outPort < 0 || static_cast<quint32>(outPort) >= _nodes[outNode].portCount[side(PortType::Out)] ||
+      inPort  < 0 || static_cast<quint32>(inPort)  >= _nodes[inNode].portCount[side(PortType::In)])
+  {
+    return false;
+  }
+
+  if (findConnection(outNode, outPort, inNode, inPort) != InvalidHandle)
+    return false;
+
+  NodeDataModel const* outModel = _nodes[outNode].model;
+  NodeDataModel const* inModel  = _nodes[inNode].model;
+
+  if (outModel->dataType(PortType::Out, outPort).atom() !=
+      inModel->dataType(PortType::In, inPort).atom())
+  {
+    return false;
+  }
+
+  auto connected = [this](Handle node, PortType portType, PortIndex portIndex)
+                   {
+                     bool any = false;
+                     forEachConnectionSlot(node, portType, portIndex, [&](Handle) { any = true; });
+                     return any;
+                   };
+
+  if (connected(inNode, PortType::In, inPort))
+    return false;
+
+  if (outModel->portOutConnectionPolicy(outPort) == ConnectionPolicy::One &&
+      connected(outNode, PortType::Out, outPort))
+  {
+    return false;
+  }
+
+  Handle connection;
+  if (!_freeConnections.empty())
+  {
+    connection = _freeConnections.back();
+    _freeConnections.pop_back();
+  }
+  else
+  {
+    connection = static_cast<Handle>(_connections.size());
+    _connections.emplace_back();
+  }
+
+  ConnectionSlot& slot = _connections[connection];
+
+  slot.outNode = outNode;
+  slot.outPort = outPort;
+  slot.inNode  = inNode;
+  slot.inPort  = inPort;
+  slot.alive   = true;
+
+  // chained in front of what its ports got since the last rebuild
+  Adjacency& out = _adjacency[side(PortType::Out)];
+  Adjacency& in  = _adjacency[side(PortType::In)];
+
+  quint32 const outIndex = out.portBase[outNode] + static_cast<quint32>(outPort);
+  quint32 const inIndex  = in.portBase[inNode] + static_cast<quint32>(inPort);
+
+  slot.next[side(PortType::Out)] = out.added[outIndex];
+  slot.next[side(PortType::In)]  = in.added[inIndex];
+
+  out.added[outIndex] = connection;
+  in.added[inIndex]   = connection;
+
+  ++_addedConnections;
+  ++_connectionCount;
+
+  scheduleRebuild();
+
+  return true;
+}
+
+
+void*
+FlatFlowModel::
+handlePointer(Handle node)
+{
+  return reinterpret_cast<void*>(static_cast<quintptr>(node));
+}
+
+
+FlatFlowModel::NodeSlot const&
+FlatFlowModel::
+nodeSlot(NodeIndex const& index) const
+{
+  return _nodes[nodeHandle(index)];
+}
+
+
+void
+FlatFlowModel::
+updateAdjacency() const
+{
+  for (PortType portType : {PortType::In, PortType::Out})
+  {
+    int const s = side(portType);
+
+    Adjacency& adjacency = _adjacency[s];
+
+    // lay the ports of all nodes out one after the other
+    adjacency.portBase.resize(_nodes.size());
+
+    quint32 portCount = 0;
+    for (std::size_t node = 0; node < _nodes.size(); ++node)
+    {
+      adjacency.portBase[node] = portCount;
+      portCount += _nodes[node].portCount[s];
+    }
+
+    // counting sort of the live connections by port
+    adjacency.offsets.assign(portCount + 1, 0);
+
+    for (auto const& connection : _connections)
+    {
+      if (!connection.alive)
+        continue;
+
+      quint32 port = (portType == PortType::Out) ?
+                     adjacency.portBase[connection.outNode] + connection.outPort :
+                     adjacency.portBase[connection.inNode] + connection.inPort;
+
+      ++adjacency.offsets[port + 1];
+    }
+
+    for (quint32 port = 0; port < portCount; ++port)
+    {
+      adjacency.offsets[port + 1] += adjacency.offsets[port];
+    }
+
+    adjacency.connections.resize(adjacency.offsets[portCount]);
+
+    std::vector<quint32> next(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+
+    for (quint32 i = 0; i < _connections.size(); ++i)
+    {
+      auto const& connection = _connections[i];
+
+      if (!connection.alive)
+        continue;
+
+      quint32 port = (portType == PortType::Out) ?
+                     adjacency.portBase[connection.outNode] + connection.outPort :
+                     adjacency.portBase[connection.inNode] + connection.inPort;
+
+      adjacency.connections[next[port]++] = i;
+    }
+
+    adjacency.added.assign(portCount, InvalidHandle);
+  }
+
+  for (auto const& connection : _connections)
+  {
+    connection.next[0] = InvalidHandle;
+    connection.next[1] = InvalidHandle;
+  }
+
+  _addedConnections = 0;
+
+  // nothing refers to removed slots anymore
+  _freeConnections.insert(_freeConnections.end(),
+                          _removedConnections.begin(), _removedConnections.end());
+  _removedConnections.clear();
+
+  _adjacencyValid = true;
+}
+
+
+void
+FlatFlowModel::
+scheduleRebuild()
+{
+  // a rebuild per quarter of the graph keeps edits amortized O(1)
+  std::size_t const limit = _connectionCount / 4 + 64;
+
+  if (_addedConnections > limit || _removedConnections.size() > limit)
+    _adjacencyValid = false;
+}
+
+
+FlatFlowModel::Handle
+FlatFlowModel::
+findConnection(Handle outNode, PortIndex outPort, Handle inNode, PortIndex inPort) const
+{
+  Handle found = InvalidHandle;
+
+  forEachConnectionSlot(outNode, PortType::Out, outPort,
+                        [&](Handle connection)
+                        {
+                          auto const& slot = _connections[connection];
+
+                          if (slot.inNode == inNode && slot.inPort == inPort)
+                            found = connection;
+                        });
+  return found;
+}
+
+} // namespace QtNodes
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <QtCore/QUuid>
+
+#include "Export.hpp"
+#include "FlowSceneModel.hpp"
+#include "NodeIndex.hpp"
+#include "PortType.hpp"
+#include "QUuidStdHash.hpp"
+
+namespace QtNodes
+{
+
+class DataModelRegistry;
+class NodeDataModel;
+
+/// A view-only FlowSceneModel for large graphs that only holds their
+/// structure. It is not a storage backend for DataFlowModel: it neither
+/// computes nor saves or loads, fill it through createNode() and
+/// createConnection() from wherever the graph comes from.
+///
+/// Nodes and connections live in contiguous slot arrays and are addressed
+/// by dense integer handles; a hash index maps node ids to handles. A node
+/// is its id, its position and the registered model it was created from,
+/// which answers every question about its ports, so nothing is cloned per
+/// node. Consequently nodes carry no data and show no embedded widget; use
+/// DataFlowModel for graphs that compute.
+///
+/// The connections of every port are kept in CSR form: one offset array
+/// per port type and one array of connection slots. Connections added
+/// since are chained per port in front of them, and removals only
+/// tombstone their slot, so edits cost O(1). The O(V+E) rebuild that
+/// folds the chains back into the arrays waits until they, or the
+/// tombstones, have grown to a fraction of the graph.
+class NODE_EDITOR_PUBLIC FlatFlowModel : public FlowSceneModel
+{
+  Q_OBJECT
+
+public:
+
+  using Handle = quint32;
+
+  static constexpr Handle InvalidHandle = std::numeric_limits<Handle>::max();
+
+  FlatFlowModel(std::shared_ptr<DataModelRegistry> registry);
+
+  ~FlatFlowModel();
+
+public:
+
+  // FlowSceneModel read interface
+  QStringList modelRegistry() const override;
+  QString nodeTypeCategory(QString const& name) const override;
+  QList<QUuid> nodeUUids() const override;
+  NodeIndex nodeIndex(QUuid const& id) const override;
+  QString nodeTypeIdentifier(NodeIndex const& index) const override;
+  QString nodeCaption(NodeIndex const& index) const override;
+  QPointF nodeLocation(NodeIndex const& index) const override;
+  QWidget* nodeWidget(NodeIndex const& index) const override;
+  bool nodeResizable(NodeIndex const& index) const override;
+  NodeValidationState nodeValidationState(NodeIndex const& index) const override;
+  QString nodeValidationMessage(NodeIndex const& index) const override;
+  NodePainterDelegate* nodePainterDelegate(NodeIndex const& index) const override;
+  NodeStyle nodeStyle(NodeIndex const& index) const override;
+  NodeStyleHandle nodeStyleHandle(NodeIndex const& index) const override;
+  unsigned int nodePortCount(NodeIndex const& index, PortType portType) const override;
+  QString nodePortCaption(NodeIndex const& index, PortType portType, PortIndex portIndex) const override;
+  NodeDataType nodePortDataType(NodeIndex const& index, PortType portType, PortIndex portIndex) const override;
+  ConnectionPolicy nodePortConnectionPolicy(NodeIndex const& index, PortType portType, PortIndex portIndex) const override;
+  std::vector<std::pair<NodeIndex, PortIndex>> nodePortConnections(NodeIndex const& index, PortType portType, PortIndex portIndex) const override;
+  void visitNodePortConnections(NodeIndex const& index, PortType portType, PortIndex portIndex, ConnectionVisitor visitor) const override;
+
+  // FlowSceneModel write interface
+  bool removeConnection(NodeIndex const& leftNode, PortIndex leftPortID, NodeIndex const& rightNode, PortIndex rightPortID) override;
+  bool addConnection(NodeIndex const& leftNode, PortIndex leftPortID, NodeIndex const& rightNode, PortIndex rightPortID) override;
+  /// Fails while the node still has connections
+  bool removeNode(NodeIndex const& index) override;
+  QUuid addNode(QString const& typeID, QPointF const& location) override;
+  bool moveNode(NodeIndex const& index, QPointF newLocation) override;
+
+public:
+
+  // handles
+
+  /// InvalidHandle for unknown ids
+  Handle
+  nodeHandle(QUuid const& id) const;
+
+  Handle
+  nodeHandle(NodeIndex const& index) const;
+
+  NodeIndex
+  nodeIndex(Handle node) const;
+
+  /// A null `id` gets a fresh one. InvalidHandle if `typeID` isn't
+  /// registered or `id` is taken.
+  Handle
+  createNode(QString const& typeID, QPointF const& location, QUuid const& id = QUuid());
+
+  /// Fails for ports out of range, duplicates, ports of different data
+  /// types, and ports already connected whose ConnectionPolicy is One, as
+  /// every in-port's is
+  bool
+  createConnection(Handle outNode, PortIndex outPort, Handle inNode, PortIndex inPort);
+
+  std::size_t
+  nodeCount() const { return _nodeIndex.size(); }
+
+  std::size_t
+  connectionCount() const { return _connectionCount; }
+
+  /// Node handles are below this; slots of removed nodes are reused
+  Handle
+  nodeSlotCount() const { return static_cast<Handle>(_nodes.size()); }
+
+  bool
+  isNode(Handle node) const
+  { return node < _nodes.size() && _nodes[node].model != nullptr; }
+
+  /// Calls `visitor(Handle node, PortIndex port)` for the other end of
+  /// every connection at the port, without allocating
+  template<typename Visitor>
+  void
+  forEachConnection(Handle node, PortType portType, PortIndex portIndex, Visitor&& visitor) const
+  {
+    forEachConnectionSlot(node, portType, portIndex,
+                          [&](Handle connection)
+                          {
+                            ConnectionSlot const& slot = _connections[connection];
+
+                            if (portType == PortType::Out)
+                              visitor(slot.inNode, slot.inPort);
+                            else
+                              visitor(slot.outNode, slot.outPort);
+                          });
+  }
+
+private:
+
+  struct NodeSlot
+  {
+    QUuid id;
+
+    // registered model, nullptr for free slots
+    NodeDataModel const* model = nullptr;
+
+    QPointF position;
+
+    // cached from `model`, indexed by side()
+    quint32 portCount[2] = {0, 0};
+  };
+
+  struct ConnectionSlot
+  {
+    Handle    outNode = InvalidHandle;
+    Handle    inNode  = InvalidHandle;
+    PortIndex outPort = INVALID;
+    PortIndex inPort  = INVALID;
+    bool      alive   = false;
+
+    // the connection added before it at the same port since the last
+    // rebuild, indexed by side()
+    mutable Handle next[2] = {InvalidHandle, InvalidHandle};
+  };
+
+  struct Adjacency
+  {
+    // first port of every node slot among all ports of this type
+    std::vector<quint32> portBase;
+
+    // connections of port p are connections[offsets[p] .. offsets[p + 1]),
+    // for the ports that existed at the last rebuild
+    std::vector<quint32> offsets;
+
+    std::vector<quint32> connections;
+
+    // per port, the newest connection added since the last rebuild
+    std::vector<Handle> added;
+  };
+
+  static
+  int
+  side(PortType portType) { return portType == PortType::Out ? 1 : 0; }
+
+  static
+  void*
+  handlePointer(Handle node);
+
+  NodeSlot const&
+  nodeSlot(NodeIndex const& index) const;
+
+  /// Calls `visitor(Handle connection)` for every live connection at the
+  /// port
+  template<typename Visitor>
+  void
+  forEachConnectionSlot(Handle node, PortType portType, PortIndex portIndex, Visitor&& visitor) const
+  {
+    Q_ASSERT(isNode(node));
+
+    if (!_adjacencyValid)
+      updateAdjacency();
+
+    int const s = side(portType);
+
+    Adjacency const& adjacency = _adjacency[s];
+
+    quint32 const port = adjacency.portBase[node] + static_cast<quint32>(portIndex);
+
+    if (port + 1 < adjacency.offsets.size())
+    {
+      for (quint32 i = adjacency.offsets[port]; i < adjacency.offsets[port + 1]; ++i)
+      {
+        if (_connections[adjacency.connections[i]].alive)
+          visitor(static_cast<Handle>(adjacency.connections[i]));
+      }
+    }
+
+    for (Handle connection = adjacency.added[port];
+         connection != InvalidHandle;
+         connection = _connections[connection].next[s])
+    {
+      if (_connections[connection].alive)
+        visitor(connection);
+    }
+  }
+
+  void
+  updateAdjacency() const;
+
+  /// Leaves the rebuild to the next traversal once enough has changed
+  void
+  scheduleRebuild();
+
+  Handle
+  findConnection(Handle outNode, PortIndex outPort, Handle inNode, PortIndex inPort) const;
+
+private:
+
+  std::shared_ptr<DataModelRegistry> _registry;
+
+  std::vector<NodeSlot>       _nodes;
+  std::vector<Handle>         _freeNodes;
+  std::unordered_map<QUuid, Handle> _nodeIndex;
+
+  std::vector<ConnectionSlot> _connections;
+  std::size_t                 _connectionCount = 0;
+
+  // removed slots are only reused once a rebuild dropped every reference
+  mutable std::vector<Handle> _freeConnections;
+  mutable std::vector<Handle> _removedConnections;
+
+  // indexed by side()
+  mutable Adjacency   _adjacency[2];
+  mutable bool        _adjacencyValid = true;
+  mutable std::size_t _addedConnections = 0;
+};
+}
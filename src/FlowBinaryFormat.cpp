@@ -0,0 +1,210 @@
+#include "FlowBinaryFormat.hpp"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <QtCore/QtEndian>
+
+namespace QtNodes {
+namespace FlowBinaryFormat {
+
+namespace {
+constexpr qint64 ChunkSize = 64 * 1024;
+}
+
+bool
+isBinary(QByteArray const& data)
+{
+  return data.size() >= static_cast<int>(sizeof(Magic)) &&
+         std::memcmp(data.constData(), Magic, sizeof(Magic)) == 0;
+}
+
+
+bool
+isBinary(QIODevice& device)
+{
+  return isBinary(device.peek(sizeof(Magic)));
+}
+
+
+Writer::
+Writer(QByteArray& out)
+  : _out(out)
+{}
+
+
+void
+Writer::
+writeMagic()
+{
+  _out.append(Magic, sizeof(Magic));
+}
+
+
+void
+Writer::
+writeVarint(quint64 value)
+{
+  // LEB128, seven bits per byte, high bit set on all but the last
+  while (value >= 0x80)
+  {
+    _out.append(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+
+  _out.append(static_cast<char>(value));
+}
+
+
+void
+Writer::
+writeDouble(double value)
+{
+  quint64 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+
+  bits = qToLittleEndian(bits);
+
+  _out.append(reinterpret_cast<char const*>(&bits), sizeof(bits));
+}
+
+
+void
+Writer::
+writeUuid(QUuid const& id)
+{
+  _out.append(id.toRfc4122());
+}
+
+
+void
+Writer::
+writeBytes(QByteArray const& bytes)
+{
+  writeVarint(static_cast<quint64>(bytes.size()));
+
+  _out.append(bytes);
+}
+
+
+void
+Writer::
+writeString(QString const& string)
+{
+  writeBytes(string.toUtf8());
+}
+
+
+Reader::
+Reader(QIODevice& device)
+  : _device(device)
+{}
+
+
+void
+Reader::
+readMagic()
+{
+  if (std::memcmp(take(sizeof(Magic)), Magic, sizeof(Magic)) != 0)
+    throw std::logic_error("Not a binary flow");
+}
+
+
+quint64
+Reader::
+readVarint()
+{
+  quint64 value = 0;
+
+  for (int shift = 0; shift < 64; shift += 7)
+  {
+    auto byte = static_cast<unsigned char>(*take(1));
+
+    value |= static_cast<quint64>(byte & 0x7f) << shift;
+
+    if ((byte & 0x80) == 0)
+      return value;
+  }
+
+  throw std::logic_error("Malformed varint in binary flow");
+}
+
+
+double
+Reader::
+readDouble()
+{
+  quint64 bits;
+  std::memcpy(&bits, take(sizeof(bits)), sizeof(bits));
+
+  bits = qFromLittleEndian(bits);
+
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+
+  return value;
+}
+
+
+QUuid
+Reader::
+readUuid()
+{
+  return QUuid::fromRfc4122(QByteArray::fromRawData(take(16), 16));
+}
+
+
+QByteArray
+Reader::
+readBytes()
+{
+  quint64 size = readVarint();
+
+  if (size > static_cast<quint64>(std::numeric_limits<int>::max() / 2))
+    throw std::logic_error("Malformed binary flow: oversized record");
+
+  int const n = static_cast<int>(size);
+
+  return QByteArray(take(n), n);
+}
+
+
+QString
+Reader::
+readString()
+{
+  return QString::fromUtf8(readBytes());
+}
+
+
+char const*
+Reader::
+take(int size)
+{
+  while (_buffer.size() - _pos < size)
+  {
+    // drop what was consumed before growing the buffer
+    if (_pos > 0)
+    {
+      _buffer.remove(0, _pos);
+      _pos = 0;
+    }
+
+    QByteArray chunk = _device.read(ChunkSize);
+
+    if (chunk.isEmpty())
+      throw std::logic_error("Truncated binary flow");
+
+    _buffer.append(chunk);
+  }
+
+  char const* p = _buffer.constData() + _pos;
+
+  _pos += size;
+
+  return p;
+}
+
+}
+} // namespace QtNodes
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <QtCore/QByteArray>
+#include <QtCore/QIODevice>
+#include <QtCore/QString>
+#include <QtCore/QUuid>
+
+namespace QtNodes
+{
+
+/// Building blocks of the binary graph format written by
+/// DataFlowModel::saveToBinary().
+///
+/// Layout, version 1:
+///
+///   magic "QNFB", varint version
+///   varint name count, names as varint length + UTF-8
+///   varint node count, per node:
+///     16 byte RFC 4122 id, varint name index, x and y as little endian
+///     doubles, varint length + compact JSON of the model's save() minus
+///     its "name" (empty if nothing else is saved)
+///   varint connection count, per connection:
+///     varint out node, varint out port, varint in node, varint in port;
+///     nodes are referred to by their position in the node table
+namespace FlowBinaryFormat
+{
+
+constexpr char    Magic[]        = { 'Q', 'N', 'F', 'B' };
+constexpr quint64 CurrentVersion = 1;
+
+/// True if `data` starts with the binary format magic
+bool
+isBinary(QByteArray const& data);
+
+/// Peeks, the device isn't advanced
+bool
+isBinary(QIODevice& device);
+
+class Writer
+{
+public:
+
+  Writer(QByteArray& out);
+
+  void
+  writeMagic();
+
+  void
+  writeVarint(quint64 value);
+
+  void
+  writeDouble(double value);
+
+  void
+  writeUuid(QUuid const& id);
+
+  void
+  writeBytes(QByteArray const& bytes);
+
+  void
+  writeString(QString const& string);
+
+private:
+
+  QByteArray& _out;
+};
+
+/// Reads the device in chunks, so only the record being decoded is held
+/// in memory. Throws std::logic_error on truncated or malformed input.
+class Reader
+{
+public:
+
+  Reader(QIODevice& device);
+
+  void
+  readMagic();
+
+  quint64
+  readVarint();
+
+  double
+  readDouble();
+
+  QUuid
+  readUuid();
+
+  QByteArray
+  readBytes();
+
+  QString
+  readString();
+
+private:
+
+  char const*
+  take(int size);
+
+private:
+
+  QIODevice& _device;
+
+  QByteArray _buffer;
+
+  int _pos = 0;
+};
+}
+}
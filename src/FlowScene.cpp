@@ -3,6 +3,9 @@
 #include "ConnectionGraphicsObject.hpp"
 #include "NodeGraphicsObject.hpp"
 
+#include <algorithm>
+#include <unordered_set>
+
 namespace QtNodes {
 
 FlowScene::FlowScene(FlowSceneModel* model) 
@@ -14,39 +17,53 @@ FlowScene::FlowScene(FlowSceneModel* model)
   connect(model, &FlowSceneModel::nodeAdded, this, &FlowScene::nodeAdded);
   connect(model, &FlowSceneModel::nodePortUpdated, this, &FlowScene::nodePortUpdated);
   connect(model, &FlowSceneModel::nodeValidationUpdated, this, &FlowScene::nodeValidationUpdated);
+  connect(model, &FlowSceneModel::nodeCaptionUpdated, this, &FlowScene::nodeCaptionUpdated);
+  connect(model, &FlowSceneModel::nodeStyleUpdated, this, &FlowScene::nodeStyleUpdated);
   connect(model, &FlowSceneModel::connectionRemoved, this, &FlowScene::connectionRemoved);
   connect(model, &FlowSceneModel::connectionAdded, this, &FlowScene::connectionAdded);
   connect(model, &FlowSceneModel::nodeMoved, this, &FlowScene::nodeMoved);
+  connect(model, &FlowSceneModel::modelReset, this, &FlowScene::modelReset);
+
+  populate();
+}
+
+FlowScene::~FlowScene() = default;
+
+void
+FlowScene::
+populate()
+{
+  // one index rebuild instead of one BSP insertion per item
+  auto indexMethod = itemIndexMethod();
+  setItemIndexMethod(QGraphicsScene::NoIndex);
 
   // emit node added on all the existing nodes
-  for (const auto& n : model->nodeUUids()) {
+  for (const auto& n : model()->nodeUUids()) {
     nodeAdded(n);
   }
   
   // add connections
-  for (const auto& n : model->nodeUUids()) {
-    auto id = model->nodeIndex(n);
+  for (const auto& n : model()->nodeUUids()) {
+    auto id = model()->nodeIndex(n);
     Q_ASSERT(id.isValid());
     
     // query the number of ports   
-    auto numPorts = model->nodePortCount(id, PortType::Out);
+    auto numPorts = model()->nodePortCount(id, PortType::Out);
     
     // go through them and add the connections
     for (auto portID = 0u; portID < numPorts; ++portID) {
-      // go through connections
-      auto connections = model->nodePortConnections(id, PortType::Out, portID);
-      
       // validate the sanity of the model--make sure if it is marked as one connection per port then there is no more than one connection
-      Q_ASSERT(model->nodePortConnectionPolicy(id, PortType::Out, portID) == ConnectionPolicy::Many || connections.size() <= 1);
+      Q_ASSERT(model()->nodePortConnectionPolicy(id, PortType::Out, portID) == ConnectionPolicy::Many || model()->nodePortConnectionCount(id, PortType::Out, portID) <= 1);
       
-      for (const auto& conn : connections) {
-        connectionAdded(id, portID, conn.first, conn.second);
-      }
+      // go through connections
+      model()->visitNodePortConnections(id, PortType::Out, portID, [&](NodeIndex const& other, PortIndex otherPortID) {
+        connectionAdded(id, portID, other, otherPortID);
+      });
     }
   }
-}
 
-FlowScene::~FlowScene() = default;
+  setItemIndexMethod(indexMethod);
+}
 
 NodeGraphicsObject*
 FlowScene::
@@ -81,12 +98,66 @@ selectedNodes() const {
 
 }
 
+void
+FlowScene::
+beginDeferredUpdates()
+{
+  ++_deferredUpdates;
+}
+
+void
+FlowScene::
+endDeferredUpdates()
+{
+  Q_ASSERT(_deferredUpdates > 0);
+
+  if (--_deferredUpdates > 0)
+    return;
+
+  auto nodes = std::move(_deferredNodes);
+  auto connections = std::move(_deferredConnections);
+  _deferredNodes.clear();
+  _deferredConnections.clear();
+
+  if (nodes.empty() && connections.empty())
+    return;
+
+  // one index rebuild instead of one BSP insertion per item
+  auto indexMethod = itemIndexMethod();
+  setItemIndexMethod(QGraphicsScene::NoIndex);
+
+  for (const auto& id : nodes) {
+    nodeAdded(id);
+  }
+
+  for (const auto& id : connections) {
+    // nodePortUpdated() queues the connections of a node again
+    if (_connGraphicsObjects.find(id) != _connGraphicsObjects.end()) continue;
+
+    connectionAdded(model()->nodeIndex(id.lNodeID), id.lPortID,
+                    model()->nodeIndex(id.rNodeID), id.rPortID);
+  }
+
+  setItemIndexMethod(indexMethod);
+}
+
 
 void 
 FlowScene::
 nodeRemoved(const QUuid& id)
 {
-  auto ngo = _nodeGraphicsObjects[id];
+  auto iter = _nodeGraphicsObjects.find(id);
+  if (iter == _nodeGraphicsObjects.end()) {
+    // never made it out of the deferred queue
+    _deferredNodes.erase(std::remove(_deferredNodes.begin(), _deferredNodes.end(), id),
+                         _deferredNodes.end());
+    return;
+  }
+
+  auto ngo = iter->second;
+
+  endNodeDrag();
+
 #ifndef NDEBUG
   // make sure there are no connections left
 
@@ -99,6 +170,7 @@ nodeRemoved(const QUuid& id)
 #endif
 
   // just delete it
+  _spatialIndex.remove(ngo);
   delete ngo;
   auto erased = _nodeGraphicsObjects.erase(id);
   Q_ASSERT(erased == 1);
@@ -107,6 +179,11 @@ void
 FlowScene::
 nodeAdded(const QUuid& newID)
 {
+  if (_deferredUpdates > 0) {
+    _deferredNodes.push_back(newID);
+    return;
+  }
+
   // make sure the ID doens't exist already
   Q_ASSERT(_nodeGraphicsObjects.find(newID) == _nodeGraphicsObjects.end());
   
@@ -131,8 +208,14 @@ nodePortUpdated(NodeIndex const& id)
 {
   
   auto thisNodeNGO = nodeGraphicsObject(id);
+
+  // still deferred, it is created with the new ports
+  if (thisNodeNGO == nullptr && (_deferredUpdates > 0 || model()->inBatch())) return;
+
   Q_ASSERT(thisNodeNGO);
 
+  endNodeDrag();
+
   // remove all the connections
   auto remConns = [&](PortType ty) {
     for (auto i = 0ull; i < thisNodeNGO->nodeState().getEntries(ty).size(); ++i) {
@@ -159,6 +242,7 @@ nodePortUpdated(NodeIndex const& id)
   // recreate the NGO
   
   // just delete it
+  _spatialIndex.remove(thisNodeNGO);
   delete thisNodeNGO;
   auto erased = _nodeGraphicsObjects.erase(id.id());
   Q_ASSERT(erased == 1);
@@ -179,20 +263,18 @@ nodePortUpdated(NodeIndex const& id)
     
     for (auto portID = 0u; portID < numPorts; ++portID) {
 
-      // go through connections
-      auto connections = model()->nodePortConnections(id, ty, portID);
-      
       // validate the sanity of the model--make sure if it is marked as one connection per port then there is no more than one connection
-      Q_ASSERT(model()->nodePortConnectionPolicy(id, ty, portID) == ConnectionPolicy::Many || connections.size() <= 1);
+      Q_ASSERT(model()->nodePortConnectionPolicy(id, ty, portID) == ConnectionPolicy::Many || model()->nodePortConnectionCount(id, ty, portID) <= 1);
       
-      for (const auto& conn : connections) {
+      // go through connections
+      model()->visitNodePortConnections(id, ty, portID, [&](NodeIndex const& other, PortIndex otherPortID) {
         
         if (ty == PortType::Out) {
-          connectionAdded(id, portID, conn.first, conn.second);
+          connectionAdded(id, portID, other, otherPortID);
         } else {
-          connectionAdded(conn.first, conn.second, id, portID);
+          connectionAdded(other, otherPortID, id, portID);
         }
-      }
+      });
     }
   };
   readdConns(PortType::In);
@@ -202,39 +284,92 @@ void
 FlowScene::
 nodeValidationUpdated(NodeIndex const& id)
 {
-  // repaint
+  // repaint, unless it wasn't created yet
   auto ngo = nodeGraphicsObject(id);
+  if (ngo == nullptr) return;
+
   ngo->setGeometryChanged();
   ngo->geometry().recalculateSize();
+  _spatialIndex.update(ngo);
   ngo->moveConnections();
   ngo->update();
   
 }
 void
 FlowScene::
-connectionRemoved(NodeIndex const& leftNode, PortIndex leftPortID, NodeIndex const& rightNode, PortIndex rightPortID)
+nodeCaptionUpdated(NodeIndex const& id)
 {
-  // check the model's sanity
-#ifndef NDEBUG
-  for (const auto& conn : model()->nodePortConnections(leftNode, PortType::Out, leftPortID)) {
-    // if you fail here, then you're emitting connectionRemoved on a connection that is in the model
-    Q_ASSERT (conn.first != rightNode || conn.second != rightPortID);
-  }
-  for (const auto& conn : model()->nodePortConnections(rightNode, PortType::In, rightPortID)) {
-    // if you fail here, then you're emitting connectionRemoved on a connection that is in the model
-    Q_ASSERT (conn.first != leftNode || conn.second != leftPortID);
+  // same relayout as a validation change
+  nodeValidationUpdated(id);
+}
+void
+FlowScene::
+nodeStyleUpdated(NodeIndex const& id)
+{
+  // not created yet, it is laid out when it is
+  auto ngo = nodeGraphicsObject(id);
+  if (ngo == nullptr) return;
+
+  // the relayout picks the new style handle up
+  nodeValidationUpdated(id);
+  ngo->applyStyle();
+}
+bool
+FlowScene::
+event(QEvent* event)
+{
+  // nodes are measured and painted in the scene font
+  if (event->type() == QEvent::FontChange)
+  {
+    for (auto const& pair : _nodeGraphicsObjects)
+    {
+      auto ngo = pair.second;
+
+      ngo->setGeometryChanged();
+      ngo->geometry().recalculateSize(font());
+      _spatialIndex.update(ngo);
+      ngo->moveConnections();
+      ngo->update();
+    }
   }
-#endif
 
+  return QGraphicsScene::event(event);
+}
+void
+FlowScene::
+connectionRemoved(NodeIndex const& leftNode, PortIndex leftPortID, NodeIndex const& rightNode, PortIndex rightPortID)
+{
   // create a connection ID
   ConnectionID id;
   id.lNodeID = leftNode.id();
   id.rNodeID = rightNode.id();
   id.lPortID = leftPortID;
   id.rPortID = rightPortID;
-  
+
+  auto iter = _connGraphicsObjects.find(id);
+  if (iter == _connGraphicsObjects.end()) {
+    // never made it out of the deferred queue
+    _deferredConnections.erase(std::remove(_deferredConnections.begin(), _deferredConnections.end(), id),
+                               _deferredConnections.end());
+    return;
+  }
+
+  // check the model's sanity
+#ifndef NDEBUG
+  model()->visitNodePortConnections(leftNode, PortType::Out, leftPortID, [&](NodeIndex const& other, PortIndex otherPortID) {
+    // if you fail here, then you're emitting connectionRemoved on a connection that is in the model
+    Q_ASSERT (other != rightNode || otherPortID != rightPortID);
+  });
+  model()->visitNodePortConnections(rightNode, PortType::In, rightPortID, [&](NodeIndex const& other, PortIndex otherPortID) {
+    // if you fail here, then you're emitting connectionRemoved on a connection that is in the model
+    Q_ASSERT (other != leftNode || otherPortID != leftPortID);
+  });
+#endif
+
+  endNodeDrag();
+
   // cgo
-  auto& cgo = *_connGraphicsObjects[id];
+  auto& cgo = *iter->second;
   
   // remove it from the nodes
   auto& lngo = *nodeGraphicsObject(leftNode);
@@ -251,6 +386,17 @@ void
 FlowScene::
 connectionAdded(NodeIndex const& leftNode, PortIndex leftPortID, NodeIndex const& rightNode, PortIndex rightPortID)
 {
+  if (_deferredUpdates > 0) {
+    ConnectionID id;
+    id.lNodeID = leftNode.id();
+    id.rNodeID = rightNode.id();
+    id.lPortID = leftPortID;
+    id.rPortID = rightPortID;
+
+    _deferredConnections.push_back(id);
+    return;
+  }
+
   // check the model's sanity
 #ifndef NDEBUG
   // if you fail here, then you're emitting connectionAdded on a portID that doesn't exist
@@ -258,25 +404,25 @@ connectionAdded(NodeIndex const& leftNode, PortIndex leftPortID, NodeIndex const
   Q_ASSERT(rightPortID < model()->nodePortCount(rightNode, PortType::In));
 
   bool checkedOut = false;
-  for (const auto& conn : model()->nodePortConnections(leftNode, PortType::Out, leftPortID)) {
-    if (conn.first == rightNode && conn.second == rightPortID) {
+  model()->visitNodePortConnections(leftNode, PortType::Out, leftPortID, [&](NodeIndex const& other, PortIndex otherPortID) {
+    if (other == rightNode && otherPortID == rightPortID) {
       checkedOut = true;
-      break;
     }
-  }
+  });
   // if you fail here, then you're emitting connectionAdded on a connection that isn't in the model
   Q_ASSERT(checkedOut);
   checkedOut = false;
-  for (const auto& conn : model()->nodePortConnections(rightNode, PortType::In, rightPortID)) {
-    if (conn.first == leftNode && conn.second == leftPortID) {
+  model()->visitNodePortConnections(rightNode, PortType::In, rightPortID, [&](NodeIndex const& other, PortIndex otherPortID) {
+    if (other == leftNode && otherPortID == leftPortID) {
       checkedOut = true;
-      break;
     }
-  }
+  });
   // if you fail here, then you're emitting connectionAdded on a connection that isn't in the model
   Q_ASSERT(checkedOut);
 #endif
   
+  endNodeDrag();
+
   // create the cgo
   auto cgo = new ConnectionGraphicsObject(leftNode, leftPortID, rightNode, rightPortID, *this);
   
@@ -292,43 +438,152 @@ connectionAdded(NodeIndex const& leftNode, PortIndex leftPortID, NodeIndex const
   
 }
 
+void
+FlowScene::
+modelReset()
+{
+  std::vector<QUuid> selected;
+  for (const auto& index : selectedNodes()) {
+    selected.push_back(index.id());
+  }
+
+  endNodeDrag();
+
+  // connections first, nodes keep pointers to them
+  for (const auto& pair : _connGraphicsObjects) {
+    delete pair.second;
+  }
+  _connGraphicsObjects.clear();
+
+  for (const auto& pair : _nodeGraphicsObjects) {
+    delete pair.second;
+  }
+  _nodeGraphicsObjects.clear();
+
+  _spatialIndex.clear();
+
+  _deferredNodes.clear();
+  _deferredConnections.clear();
+
+  populate();
+
+  for (const auto& id : selected) {
+    auto ngo = nodeGraphicsObject(id);
+    if (ngo != nullptr) ngo->setSelected(true);
+  }
+}
+
 void
 FlowScene::
 nodeMoved(NodeIndex const& index) {
-  _nodeGraphicsObjects[index.id()]->setPos(model()->nodeLocation(index));
+  auto ngo = nodeGraphicsObject(index);
+
+  // deferred nodes pick their location up when they are created
+  if (ngo == nullptr) return;
+
+  ngo->setPos(model()->nodeLocation(index));
+
+  // the position may not have changed, the size of a new node has
+  _spatialIndex.update(ngo);
 }
 
-NodeGraphicsObject*
-locateNodeAt(QPointF scenePoint, FlowScene &scene,
-             QTransform viewTransform)
+void
+FlowScene::
+beginNodeDrag(NodeGraphicsObject& anchor)
 {
-  // items under cursor
-  QList<QGraphicsItem*> items =
-    scene.items(scenePoint,
-                Qt::IntersectsItemShape,
-                Qt::DescendingOrder,
-                viewTransform);
-
-  //// items convertable to NodeGraphicsObject
-  std::vector<QGraphicsItem*> filteredItems;
-
-  std::copy_if(items.begin(),
-               items.end(),
-               std::back_inserter(filteredItems),
-               [] (QGraphicsItem * item)
-    {
-      return (dynamic_cast<NodeGraphicsObject*>(item) != nullptr);
-    });
+  if (_nodeDrag.anchor != nullptr)
+    return;
 
-  if (!filteredItems.empty())
-  {
-    QGraphicsItem* graphicsItem = filteredItems.front();
-    auto ngo = dynamic_cast<NodeGraphicsObject*>(graphicsItem);
+  _nodeDrag.anchor    = &anchor;
+  _nodeDrag.anchorPos = anchor.pos();
+
+  // the nodes QGraphicsItem::mouseMoveEvent moves along with the anchor
+  _nodeDrag.nodes.push_back(&anchor);
 
-    return ngo;
+  for (QGraphicsItem* item : selectedItems()) {
+    auto ngo = qgraphicsitem_cast<NodeGraphicsObject*>(item);
+
+    if (ngo != nullptr && ngo != &anchor && (ngo->flags() & QGraphicsItem::ItemIsMovable)) {
+      _nodeDrag.nodes.push_back(ngo);
+    }
+  }
+
+  std::unordered_set<NodeGraphicsObject*> dragged(_nodeDrag.nodes.begin(), _nodeDrag.nodes.end());
+
+  for (auto ngo : _nodeDrag.nodes) {
+    for (auto ty : {PortType::Out, PortType::In}) {
+      for (const auto& connections : ngo->nodeState().getEntries(ty)) {
+        for (auto cgo : connections) {
+          bool const otherDragged = dragged.count(nodeGraphicsObject(cgo->node(oppositePort(ty)))) != 0;
+
+          if (!otherDragged) {
+            _nodeDrag.boundary.push_back(cgo);
+          } else if (ty == PortType::Out) {
+            // seen from both ends, keep it once
+            _nodeDrag.internal.push_back(cgo);
+          }
+        }
+      }
+    }
   }
+}
+
+void
+FlowScene::
+flushNodeDrag()
+{
+  if (_nodeDrag.anchor == nullptr)
+    return;
+
+  // every dragged node moved by the same offset
+  QPointF const delta = _nodeDrag.anchor->pos() - _nodeDrag.anchorPos;
+
+  if (delta.isNull())
+    return;
+
+  _nodeDrag.anchorPos = _nodeDrag.anchor->pos();
+
+  for (auto cgo : _nodeDrag.internal) {
+    // selected connections were moved along with the nodes
+    if (cgo->isSelected() && (cgo->flags() & QGraphicsItem::ItemIsMovable))
+      continue;
+
+    // the curve doesn't change shape, move the item instead of its ends
+    cgo->moveBy(delta.x(), delta.y());
+  }
+
+  for (auto cgo : _nodeDrag.boundary) {
+    cgo->move();
+  }
+
+  // the model may react by changing the scene, which ends the drag
+  std::vector<std::pair<NodeIndex, QPointF>> locations;
+  locations.reserve(_nodeDrag.nodes.size());
+
+  for (auto ngo : _nodeDrag.nodes) {
+    locations.emplace_back(ngo->index(), ngo->pos());
+  }
+
+  for (const auto& location : locations) {
+    model()->moveNode(location.first, location.second);
+  }
+}
+
+void
+FlowScene::
+endNodeDrag()
+{
+  _nodeDrag = NodeDrag();
+}
+
+NodeGraphicsObject*
+locateNodeAt(QPointF scenePoint, FlowScene &scene,
+             QTransform viewTransform)
+{
+  // nodes don't ignore transformations, the view doesn't matter
+  Q_UNUSED(viewTransform);
 
-  return nullptr;
+  return scene.nodeAt(scenePoint);
 }
 
 } // namespace QtNodes
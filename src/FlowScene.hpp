@@ -12,6 +12,7 @@
 #include "Export.hpp"
 #include "ConnectionID.hpp"
 #include "DataModelRegistry.hpp"
+#include "SpatialIndex.hpp"
 
 namespace QtNodes
 {
@@ -43,18 +44,74 @@ public:
 
   std::vector<NodeIndex> selectedNodes() const;
 
+  /// Topmost node under `scenePoint`, looked up in a grid of the node
+  /// bounding rects rather than among all the items of the scene
+  NodeGraphicsObject* nodeAt(QPointF const& scenePoint) const { return _spatialIndex.nodeAt(scenePoint); }
+
+  /// Topmost node with a port of `portType` under `scenePoint`, and that
+  /// port. {nullptr, INVALID} if there is none.
+  std::pair<NodeGraphicsObject*, PortIndex> portAt(QPointF const& scenePoint, PortType portType) const { return _spatialIndex.portAt(scenePoint, portType); }
+
+  /// Until the matching endDeferredUpdates(), graphics objects for added
+  /// nodes and connections are only queued. The outermost end creates all
+  /// of them in one pass and rebuilds the item index once instead of on
+  /// every insertion. Calls nest.
+  void beginDeferredUpdates();
+  void endDeferredUpdates();
+
+protected:
+
+  /// Lays the nodes out again when the scene font changes
+  bool event(QEvent* event) override;
+
 private slots:
 
   void nodeRemoved(const QUuid& id);
   void nodeAdded(const QUuid& newID);
   void nodePortUpdated(NodeIndex const& id);
   void nodeValidationUpdated(NodeIndex const& id);
+  void nodeCaptionUpdated(NodeIndex const& id);
+  void nodeStyleUpdated(NodeIndex const& id);
   void connectionRemoved(NodeIndex const& leftNode, PortIndex leftPortID, NodeIndex const& rightNode, PortIndex rightPortID);
   void connectionAdded(NodeIndex const& leftNode, PortIndex leftPortID, NodeIndex const& rightNode, PortIndex rightPortID);
   void nodeMoved(NodeIndex const& index);
+  void modelReset();
 
 private:
 
+  /// Creates graphics objects for everything in the model
+  void populate();
+
+  /// While nodes are dragged, their connections are sorted once into the
+  /// ones between two dragged nodes, which only translate, and the ones
+  /// leaving the selection, which are laid out again. Position changes
+  /// reach the model and the connections once per flush instead of once
+  /// per node and axis.
+  struct NodeDrag
+  {
+    // the grabbed node, nullptr outside of a drag
+    NodeGraphicsObject* anchor = nullptr;
+
+    // where the anchor was at the last flush
+    QPointF anchorPos;
+
+    std::vector<NodeGraphicsObject*>       nodes;
+    std::vector<ConnectionGraphicsObject*> internal;
+    std::vector<ConnectionGraphicsObject*> boundary;
+  };
+
+  /// Starts a drag of `anchor` and the other selected movable nodes,
+  /// unless one is running
+  void beginNodeDrag(NodeGraphicsObject& anchor);
+
+  /// Brings the connections and the model up to date after the dragged
+  /// nodes moved
+  void flushNodeDrag();
+
+  /// Also called when graphics objects are created or deleted mid drag,
+  /// the next mouse move starts over
+  void endNodeDrag();
+
   FlowSceneModel* _model;
 
   std::unordered_map<QUuid, NodeGraphicsObject*> _nodeGraphicsObjects;
@@ -63,6 +120,15 @@ private:
   // This is for when you're creating a connection
   ConnectionGraphicsObject* _temporaryConn = nullptr;
 
+  // node bounding rects, kept current by the NodeGraphicsObjects
+  SpatialIndex _spatialIndex;
+
+  NodeDrag _nodeDrag;
+
+  int                       _deferredUpdates = 0;
+  std::vector<QUuid>        _deferredNodes;
+  std::vector<ConnectionID> _deferredConnections;
+
 };
 
 NodeGraphicsObject*
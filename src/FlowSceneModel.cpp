@@ -12,14 +12,23 @@ bool FlowSceneModel::removeNodeWithConnections(NodeIndex const& index) {
   // delete the conenctions that node has first
   auto deleteConnections = [&](PortType ty) -> bool {
     for (PortIndex portID = 0; portID < nodePortCount(index, ty); ++portID) {
-      auto inputConnections = nodePortConnections(index, ty, portID);
-      for (const auto& conn : inputConnections) {
+      // removing changes the port's connections, so take the last one each
+      // round instead of walking them; counting first keeps a model that
+      // claims success without removing anything from looping forever
+      for (auto count = nodePortConnectionCount(index, ty, portID); count > 0; --count) {
+        NodeIndex other;
+        PortIndex otherPortID = INVALID;
+        visitNodePortConnections(index, ty, portID, [&](NodeIndex const& node, PortIndex port) {
+          other = node;
+          otherPortID = port;
+        });
+
         // try to remove it
         bool success;
         if (ty == PortType::In) {
-          success = removeConnection(conn.first, conn.second, index, portID);
+          success = removeConnection(other, otherPortID, index, portID);
         } else {
-          success = removeConnection(index, portID, conn.first, conn.second);
+          success = removeConnection(index, portID, other, otherPortID);
         }
 
         // failed, abort the node deletion
@@ -40,6 +49,48 @@ bool FlowSceneModel::removeNodeWithConnections(NodeIndex const& index) {
   return removeNode(index);
 }
 
+void FlowSceneModel::visitNodePortConnections(NodeIndex const& index, PortType portType, PortIndex portID, ConnectionVisitor visitor) const {
+  for (const auto& conn : nodePortConnections(index, portType, portID)) {
+    visitor(conn.first, conn.second);
+  }
+}
+
+std::size_t FlowSceneModel::nodePortConnectionCount(NodeIndex const& index, PortType portType, PortIndex portID) const {
+  std::size_t count = 0;
+  visitNodePortConnections(index, portType, portID, [&](NodeIndex const&, PortIndex) { ++count; });
+  return count;
+}
+
+QStringList FlowSceneModel::converterNodes(NodeDataType const& lhs, NodeDataType const& rhs) const {
+  QString converter = converterNode(lhs, rhs);
+
+  if (converter.isEmpty()) return {};
+
+  return {converter};
+}
+
+void FlowSceneModel::beginBatch() {
+  ++_batchDepth;
+}
+
+void FlowSceneModel::endBatch() {
+  Q_ASSERT(_batchDepth > 0);
+
+  if (--_batchDepth > 0 || !_batchChanged) return;
+
+  _batchChanged = false;
+
+  emit modelReset();
+}
+
+bool FlowSceneModel::deferToBatch() {
+  if (_batchDepth == 0) return false;
+
+  _batchChanged = true;
+
+  return true;
+}
+
 NodeIndex FlowSceneModel::createIndex(const QUuid& id, void* internalPointer) const
 {
   return NodeIndex(id, internalPointer, this);
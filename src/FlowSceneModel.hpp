@@ -6,12 +6,15 @@
 #include "StyleCollection.hpp"
 
 #include <cstddef>
+#include <memory>
+#include <type_traits>
 
 #include <QString>
 #include <QPointF>
 #include <QObject>
 #include <QUuid>
 #include <QList>
+#include <QStringList>
 
 
 namespace QtNodes
@@ -34,6 +37,30 @@ enum class NodeValidationState
 };
 
 
+/// Non-owning reference to a callable taking `(NodeIndex const& node,
+/// PortIndex port)`, so visitors go through the virtual interface without
+/// being copied or allocated. Only valid while the callable is alive.
+class ConnectionVisitor {
+public:
+
+  template<typename Callable,
+           typename = std::enable_if_t<!std::is_same<std::decay_t<Callable>, ConnectionVisitor>::value>>
+  ConnectionVisitor(Callable&& callable)
+    : _callable(const_cast<void*>(static_cast<void const*>(std::addressof(callable))))
+    , _call([](void* c, NodeIndex const& node, PortIndex port) {
+        (*static_cast<std::remove_reference_t<Callable>*>(c))(node, port);
+      })
+  {}
+
+  void operator()(NodeIndex const& node, PortIndex port) const { _call(_callable, node, port); }
+
+private:
+
+  void* _callable;
+  void (*_call)(void*, NodeIndex const&, PortIndex);
+};
+
+
 class NODE_EDITOR_PUBLIC FlowSceneModel : public QObject {
   Q_OBJECT
 
@@ -53,6 +80,15 @@ public:
   /// Get the conerter node type name, or "" if there is none.
   virtual QString converterNode(NodeDataType const& /*lhs*/, NodeDataType const& ) const { return {}; }
 
+  /// Get the node type names that convert `lhs` to `rhs` when connected one
+  /// after the other, empty if there are none. Defaults to the single
+  /// converterNode().
+  virtual QStringList converterNodes(NodeDataType const& lhs, NodeDataType const& rhs) const;
+
+  /// Whether converterNodes() would find a chain. Called for every port on
+  /// every repaint while a connection is dragged, so keep it cheap.
+  virtual bool canConvert(NodeDataType const& lhs, NodeDataType const& rhs) const { return !converterNode(lhs, rhs).isEmpty(); }
+
   // Retrieval functions
   //////////////////////
 
@@ -88,6 +124,11 @@ public:
   
   /// Get the style
   virtual NodeStyle nodeStyle(NodeIndex const& /* index */) const { return StyleCollection::nodeStyle(); }
+
+  /// Get the style without copying it. Views cache the handle until
+  /// nodeStyleUpdated. Override to share styles; the default wraps a copy
+  /// of nodeStyle(), so overriding only that keeps working.
+  virtual NodeStyleHandle nodeStyleHandle(NodeIndex const& index) const { return std::make_shared<NodeStyle const>(nodeStyle(index)); }
   
   /// Get the count of DataPorts
   virtual unsigned int nodePortCount(NodeIndex const& index, PortType portType) const = 0;
@@ -104,6 +145,15 @@ public:
   /// Get a connection at a port
   virtual std::vector<std::pair<NodeIndex, PortIndex>> nodePortConnections(NodeIndex const& index, PortType portTypes, PortIndex portID) const = 0;
 
+  /// Call `visitor` with the other end of every connection at a port,
+  /// straight from the model's storage. The default goes through
+  /// nodePortConnections(); override it so views don't allocate per port.
+  /// The model must not change while visiting.
+  virtual void visitNodePortConnections(NodeIndex const& index, PortType portType, PortIndex portID, ConnectionVisitor visitor) const;
+
+  /// Number of connections at a port, through visitNodePortConnections()
+  std::size_t nodePortConnectionCount(NodeIndex const& index, PortType portType, PortIndex portID) const;
+
   // Mutation functions
   /////////////////////
 
@@ -129,6 +179,23 @@ public:
   
   // try to remove all connections and then the node
   bool removeNodeWithConnections(NodeIndex const& index);
+
+  /// Batching
+  ////////////
+
+  /// Until the matching endBatch(), nodeAdded, connectionAdded, nodeMoved,
+  /// nodePortUpdated, nodeValidationUpdated, nodeCaptionUpdated and
+  /// nodeStyleUpdated are not emitted; the outermost endBatch() emits a
+  /// single modelReset() instead if anything changed. Removals are still
+  /// announced one by one, views hold pointers into the nodes they show.
+  /// Calls nest.
+  ///
+  /// Anything relaying the suppressed signals, like DataFlowScene's
+  /// nodeCreated and connectionCreated, only sees the modelReset(). To
+  /// keep those, batch on the view with FlowScene::beginDeferredUpdates().
+  void beginBatch();
+  void endBatch();
+  bool inBatch() const { return _batchDepth > 0; }
   
 public:
   
@@ -151,15 +218,31 @@ signals:
   void nodeAdded(QUuid const& newID);
   void nodePortUpdated(NodeIndex const& id);
   void nodeValidationUpdated(NodeIndex const& id);  
+  void nodeCaptionUpdated(NodeIndex const& id);
+  void nodeStyleUpdated(NodeIndex const& id);
   void connectionAboutToBeRemoved(NodeIndex const& leftNode, PortIndex leftPortID, NodeIndex const& rightNode, PortIndex rightPortID);
   void connectionRemoved(NodeIndex const& leftNode, PortIndex leftPortID, NodeIndex const& rightNode, PortIndex rightPortID);
   void connectionAdded(NodeIndex const& leftNode, PortIndex leftPortID, NodeIndex const& rightNode, PortIndex rightPortID);
   void nodeMoved(NodeIndex const& index);
 
+  /// Anything may have changed, views should rebuild from scratch. Emitted
+  /// by endBatch(), and by implementations replacing their whole contents.
+  void modelReset();
+
 protected:
 
   NodeIndex createIndex(const QUuid& id, void* internalPointer) const;
 
+  /// For implementations, call before emitting one of the signals batches
+  /// suppress. Returns true, and records that a modelReset() is due, if
+  /// the signal has to be dropped.
+  bool deferToBatch();
+
+private:
+
+  int  _batchDepth   = 0;
+  bool _batchChanged = false;
+
 };
 
 } // namespace QtNodes
@@ -5,6 +5,13 @@
 #include <QtGui/QPen>
 #include <QtGui/QBrush>
 #include <QtWidgets/QMenu>
+#include <QtWidgets/QOpenGLWidget>
+
+#include <QtGui/QGuiApplication>
+#include <QtGui/QOffscreenSurface>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QSurfaceFormat>
 
 #include <QtCore/QRectF>
 #include <QtCore/QPointF>
@@ -26,12 +33,85 @@
 using QtNodes::FlowView;
 using QtNodes::FlowScene;
 
+namespace
+{
+
+struct OpenGLSupport
+{
+  bool available = false;
+
+  // llvmpipe and friends, which multisample on the CPU
+  bool software = false;
+};
+
+
+OpenGLSupport
+probeOpenGL()
+{
+  OpenGLSupport support;
+
+  // these platform plugins have no windowing system to render into
+  QString const platform = QGuiApplication::platformName();
+
+  if (platform == QLatin1String("offscreen") ||
+      platform == QLatin1String("minimal"))
+    return support;
+
+  QOpenGLContext context;
+
+  if (!context.create())
+    return support;
+
+  QOffscreenSurface surface;
+  surface.setFormat(context.format());
+  surface.create();
+
+  if (!surface.isValid() || !context.makeCurrent(&surface))
+    return support;
+
+  auto renderer =
+    reinterpret_cast<char const*>(context.functions()->glGetString(GL_RENDERER));
+
+  QByteArray const name = QByteArray(renderer).toLower();
+
+  support.available = true;
+  support.software  = name.contains("llvmpipe") ||
+                      name.contains("softpipe") ||
+                      name.contains("software") ||
+                      name.contains("swiftshader");
+
+  context.doneCurrent();
+
+  return support;
+}
+
+
+// grid spacings in scene units
+constexpr double FineGridStep   = 50.0;
+constexpr double CoarseGridStep = 500.0;
+
+// in device pixels
+constexpr double MinGridSpacing  = 4.0;
+constexpr int    MaxGridTileSize = 2048;
+
+
+OpenGLSupport const&
+openGLSupport()
+{
+  static OpenGLSupport const support = probeOpenGL();
+
+  return support;
+}
+}
+
+
 FlowView::
 FlowView(QWidget *parent)
   : QGraphicsView(parent)
   , _clearSelectionAction(Q_NULLPTR)
   , _deleteSelectionAction(Q_NULLPTR)
   , _scene(Q_NULLPTR)
+  , _viewportMode(ViewportMode::Raster)
 {
 
   setDragMode(QGraphicsView::ScrollHandDrag);
@@ -49,8 +129,6 @@ FlowView(QWidget *parent)
   setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
 
   setCacheMode(QGraphicsView::CacheBackground);
-
-  //setViewport(new QGLWidget(QGLFormat(QGL::SampleBuffers)));
 }
 
 FlowView::
@@ -376,55 +454,209 @@ int FlowView::mouseY() const
 }
 
 
+FlowView::ViewportMode
+FlowView::
+setViewportMode(ViewportMode mode)
+{
+  if (mode == ViewportMode::OpenGL && !openGLAvailable())
+  {
+    qWarning() << "FlowView: OpenGL is not available, using the raster viewport";
+
+    mode = ViewportMode::Raster;
+  }
+
+  if (mode == _viewportMode)
+    return _viewportMode;
+
+  if (mode == ViewportMode::OpenGL)
+  {
+    QSurfaceFormat format = QSurfaceFormat::defaultFormat();
+
+    // antialiasing comes from multisampling, too slow to do on the CPU
+    format.setSamples(openGLSupport().software ? 0 : 4);
+
+    auto glWidget = new QOpenGLWidget;
+    glWidget->setFormat(format);
+
+    setViewport(glWidget);
+
+    // the framebuffer isn't kept between frames, partial updates would
+    // leave the rest of it undefined
+    setViewportUpdateMode(QGraphicsView::FullViewportUpdate);
+  }
+  else
+  {
+    setViewport(new QWidget);
+
+    setViewportUpdateMode(QGraphicsView::MinimalViewportUpdate);
+  }
+
+  // the drag cursor was set on the old viewport
+  auto const drag = dragMode();
+  setDragMode(QGraphicsView::NoDrag);
+  setDragMode(drag);
+
+  _viewportMode = mode;
+
+  return _viewportMode;
+}
+
+
+bool
+FlowView::
+openGLAvailable()
+{
+  return openGLSupport().available;
+}
+
+
 void
 FlowView::
 drawBackground(QPainter* painter, const QRectF& r)
 {
   QGraphicsView::drawBackground(painter, r);
 
+  double const scale = transform().m11();
+
+  // closer lines merge into a flat tint, not worth drawing
+  if (CoarseGridStep * scale < MinGridSpacing)
+    return;
+
+  bool const fine = FineGridStep * scale >= MinGridSpacing;
+
+  auto const &flowViewStyle = StyleCollection::flowViewStyle();
+
+  double const dpr = devicePixelRatioF();
+
+  // one coarse cell in device pixels, the tile is rendered at that size
+  int const tileSize = qMax(1, qRound(CoarseGridStep * scale * dpr));
+
+  if (tileSize <= MaxGridTileSize)
+  {
+    if (_gridTile.size != tileSize ||
+        _gridTile.devicePixelRatio != dpr ||
+        _gridTile.fine != fine ||
+        _gridTile.fineColor != flowViewStyle.FineGridColor ||
+        _gridTile.coarseColor != flowViewStyle.CoarseGridColor)
+    {
+      updateGridTile(tileSize, dpr, fine);
+    }
+
+    // the tile is tileSize / dpr units wide, this stretches it over exactly
+    // one coarse cell so the pattern can't drift from the scene grid
+    double const tileScale = CoarseGridStep * dpr / tileSize;
+
+    // whole cells, so the pattern starts on a coarse line like the grid does
+    QRectF const cells(QPointF(std::floor(r.left() / CoarseGridStep),
+                               std::floor(r.top() / CoarseGridStep)) * CoarseGridStep,
+                       QPointF(std::ceil(r.right() / CoarseGridStep),
+                               std::ceil(r.bottom() / CoarseGridStep)) * CoarseGridStep);
+
+    painter->save();
+    painter->scale(tileScale, tileScale);
+    painter->drawTiledPixmap(QRectF(cells.topLeft() / tileScale,
+                                    cells.size() / tileScale),
+                             _gridTile.pixmap);
+    painter->restore();
+
+    return;
+  }
+
+  // zoomed in too far for a tile, draw the few visible lines directly
   auto drawGrid =
     [&](double gridStep)
     {
-      QRect   windowRect = rect();
-      QPointF tl = mapToScene(windowRect.topLeft());
-      QPointF br = mapToScene(windowRect.bottomRight());
+      double left   = std::floor(r.left() / gridStep - 0.5);
+      double right  = std::floor(r.right() / gridStep + 1.0);
+      double bottom = std::floor(r.top() / gridStep - 0.5);
+      double top    = std::floor (r.bottom() / gridStep + 1.0);
 
-      double left   = std::floor(tl.x() / gridStep - 0.5);
-      double right  = std::floor(br.x() / gridStep + 1.0);
-      double bottom = std::floor(tl.y() / gridStep - 0.5);
-      double top    = std::floor (br.y() / gridStep + 1.0);
+      QVector<QLineF> lines;
+      lines.reserve(int(right - left) + int(top - bottom) + 2);
 
       // vertical lines
       for (int xi = int(left); xi <= int(right); ++xi)
       {
-        QLineF line(xi * gridStep, bottom * gridStep,
-                    xi * gridStep, top * gridStep );
-
-        painter->drawLine(line);
+        lines.append(QLineF(xi * gridStep, bottom * gridStep,
+                            xi * gridStep, top * gridStep));
       }
 
       // horizontal lines
       for (int yi = int(bottom); yi <= int(top); ++yi)
       {
-        QLineF line(left * gridStep, yi * gridStep,
-                    right * gridStep, yi * gridStep );
-        painter->drawLine(line);
+        lines.append(QLineF(left * gridStep, yi * gridStep,
+                            right * gridStep, yi * gridStep));
       }
-    };
-
-  auto const &flowViewStyle = StyleCollection::flowViewStyle();
 
-  QBrush bBrush = backgroundBrush();
+      // one call per grid, the GL engine draws it as a single batch
+      painter->drawLines(lines);
+    };
 
   QPen pfine(flowViewStyle.FineGridColor, 1.0);
 
   painter->setPen(pfine);
-  drawGrid(50);
+  drawGrid(FineGridStep);
 
   QPen p(flowViewStyle.CoarseGridColor, 1.0);
 
   painter->setPen(p);
-  drawGrid(500);
+  drawGrid(CoarseGridStep);
+}
+
+
+void
+FlowView::
+updateGridTile(int tileSize, double dpr, bool fine)
+{
+  auto const &flowViewStyle = StyleCollection::flowViewStyle();
+
+  _gridTile.size             = tileSize;
+  _gridTile.devicePixelRatio = dpr;
+  _gridTile.fine             = fine;
+  _gridTile.fineColor        = flowViewStyle.FineGridColor;
+  _gridTile.coarseColor      = flowViewStyle.CoarseGridColor;
+
+  _gridTile.pixmap = QPixmap(tileSize, tileSize);
+  _gridTile.pixmap.fill(Qt::transparent);
+
+  QPainter painter(&_gridTile.pixmap);
+  painter.setRenderHints(renderHints());
+
+  // draw in scene units, pens scale with the zoom as they do in the view
+  double const k = tileSize / CoarseGridStep;
+  painter.scale(k, k);
+
+  // lines on the tile edges are drawn on both sides, each copy shows the
+  // half that falls inside the tile
+  if (fine)
+  {
+    QVector<QLineF> lines;
+
+    for (double x = 0.0; x <= CoarseGridStep; x += FineGridStep)
+    {
+      lines.append(QLineF(x, 0.0, x, CoarseGridStep));
+      lines.append(QLineF(0.0, x, CoarseGridStep, x));
+    }
+
+    painter.setPen(QPen(flowViewStyle.FineGridColor, 1.0));
+    painter.drawLines(lines);
+  }
+
+  QVector<QLineF> lines;
+
+  for (double x : {0.0, CoarseGridStep})
+  {
+    lines.append(QLineF(x, 0.0, x, CoarseGridStep));
+    lines.append(QLineF(0.0, x, CoarseGridStep, x));
+  }
+
+  painter.setPen(QPen(flowViewStyle.CoarseGridColor, 1.0));
+  painter.drawLines(lines);
+
+  painter.end();
+
+  // set once drawn, the lines above are laid out in device pixels
+  _gridTile.pixmap.setDevicePixelRatio(dpr);
 }
 
 
@@ -2,6 +2,9 @@
 
 #include <QtWidgets/QGraphicsView>
 
+#include <QtGui/QColor>
+#include <QtGui/QPixmap>
+
 #include "Export.hpp"
 
 namespace QtNodes
@@ -12,6 +15,15 @@ class FlowScene;
 class NODE_EDITOR_PUBLIC FlowView
   : public QGraphicsView
 {
+public:
+
+  enum class ViewportMode
+  {
+    Raster,
+    /// QOpenGLWidget, multisampled unless the driver rasterizes in software
+    OpenGL
+  };
+
 public:
 
   FlowView(QWidget *parent = Q_NULLPTR);
@@ -32,6 +44,19 @@ public:
   int mouseX() const;
   int mouseY() const;
 
+  /// Replaces the viewport widget. OpenGL falls back to Raster with a
+  /// warning where no context can be created, e.g. on headless machines.
+  /// Each mode brings its viewport update mode, FullViewportUpdate for
+  /// OpenGL and MinimalViewportUpdate for Raster; call
+  /// setViewportUpdateMode() afterwards to override it.
+  /// Returns the mode in effect.
+  ViewportMode setViewportMode(ViewportMode mode);
+
+  ViewportMode viewportMode() const { return _viewportMode; }
+
+  /// Whether this platform can create an OpenGL context, probed once
+  static bool openGLAvailable();
+
 public slots:
 
   void scaleUp();
@@ -64,12 +89,34 @@ protected:
 
 private:
 
+  /// Renders one coarse grid cell, `tileSize` device pixels square, for a
+  /// screen with the device pixel ratio `dpr`
+  void updateGridTile(int tileSize, double dpr, bool fine);
+
+private:
+
+  // what drawBackground() tiles the grid with, and what it was rendered for
+  struct GridTile
+  {
+    QPixmap pixmap;
+    int     size = 0;
+    double  devicePixelRatio = 1.0;
+    bool    fine = false;
+    QColor  fineColor;
+    QColor  coarseColor;
+  };
+
   QAction* _clearSelectionAction;
   QAction* _deleteSelectionAction;
 
   QPointF _clickPos;
 
   FlowScene* _scene;
+
+  ViewportMode _viewportMode;
+
+  GridTile _gridTile;
+
   int _mouseX;
   int _mouseY;
 };
@@ -0,0 +1,241 @@
+#include "JsonRecordReader.hpp"
+
+#include <stdexcept>
+
+namespace QtNodes {
+
+namespace {
+constexpr qint64 ChunkSize = 64 * 1024;
+}
+
+JsonRecordReader::
+JsonRecordReader(QIODevice& device)
+  : _device(device)
+{}
+
+
+void
+JsonRecordReader::
+read(RecordVisitor const& visitor)
+{
+  skipWhitespace();
+  expect('{');
+  skipWhitespace();
+
+  if (peek() == '}')
+    return;
+
+  QByteArray key;
+  QByteArray record;
+
+  while (true)
+  {
+    key.clear();
+    readString(&key);
+
+    // drop the quotes
+    key = key.mid(1, key.size() - 2);
+
+    skipWhitespace();
+    expect(':');
+    skipWhitespace();
+
+    if (peek() == '[')
+    {
+      get();
+      skipWhitespace();
+
+      if (peek() == ']')
+      {
+        get();
+      }
+      else
+      {
+        while (true)
+        {
+          record.clear();
+          readValue(&record);
+
+          visitor(key, record);
+
+          skipWhitespace();
+
+          char c = get();
+          if (c == ']')
+            break;
+          if (c != ',')
+            throw std::logic_error("Malformed flow: expected ',' or ']'");
+
+          skipWhitespace();
+        }
+      }
+    }
+    else
+    {
+      readValue(nullptr);
+    }
+
+    skipWhitespace();
+
+    char c = get();
+    if (c == '}')
+      return;
+    if (c != ',')
+      throw std::logic_error("Malformed flow: expected ',' or '}'");
+
+    skipWhitespace();
+  }
+}
+
+
+bool
+JsonRecordReader::
+atEnd()
+{
+  if (_pos < _buffer.size())
+    return false;
+
+  _buffer = _device.read(ChunkSize);
+  _pos = 0;
+
+  return _buffer.isEmpty();
+}
+
+
+char
+JsonRecordReader::
+peek()
+{
+  if (atEnd())
+    throw std::logic_error("Truncated flow");
+
+  return _buffer.at(_pos);
+}
+
+
+char
+JsonRecordReader::
+get()
+{
+  char c = peek();
+
+  ++_pos;
+
+  return c;
+}
+
+
+void
+JsonRecordReader::
+expect(char c)
+{
+  if (get() != c)
+    throw std::logic_error(std::string("Malformed flow: expected '") + c + "'");
+}
+
+
+void
+JsonRecordReader::
+skipWhitespace()
+{
+  while (!atEnd())
+  {
+    char c = _buffer.at(_pos);
+
+    if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+      return;
+
+    ++_pos;
+  }
+}
+
+
+void
+JsonRecordReader::
+readValue(QByteArray* out)
+{
+  char c = peek();
+
+  if (c == '"')
+  {
+    readString(out);
+    return;
+  }
+
+  if (c != '{' && c != '[')
+  {
+    // number, true, false or null
+    while (!atEnd())
+    {
+      c = _buffer.at(_pos);
+
+      if (c == ',' || c == ']' || c == '}' ||
+          c == ' ' || c == '\t' || c == '\n' || c == '\r')
+        return;
+
+      if (out)
+        out->append(c);
+
+      ++_pos;
+    }
+
+    return;
+  }
+
+  // nesting is all that matters, QJsonDocument validates the record
+  int depth = 0;
+
+  do
+  {
+    c = peek();
+
+    if (c == '"')
+    {
+      readString(out);
+      continue;
+    }
+
+    if (c == '{' || c == '[')
+      ++depth;
+    else if (c == '}' || c == ']')
+      --depth;
+
+    if (out)
+      out->append(c);
+
+    ++_pos;
+  }
+  while (depth > 0);
+}
+
+
+void
+JsonRecordReader::
+readString(QByteArray* out)
+{
+  expect('"');
+
+  if (out)
+    out->append('"');
+
+  while (true)
+  {
+    char c = get();
+
+    if (out)
+      out->append(c);
+
+    if (c == '"')
+      return;
+
+    if (c == '\\')
+    {
+      c = get();
+
+      if (out)
+        out->append(c);
+    }
+  }
+}
+
+} // namespace QtNodes
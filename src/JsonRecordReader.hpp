@@ -0,0 +1,62 @@
+#pragma once
+
+#include <functional>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QIODevice>
+
+namespace QtNodes
+{
+
+/// Splits a JSON document of the form `{ "key": [ {...}, {...} ], ... }`
+/// into the raw text of its array elements while reading the device in
+/// chunks, so no DOM of the whole document is ever built. Each element is
+/// small enough to hand to QJsonDocument on its own.
+class JsonRecordReader
+{
+public:
+
+  using RecordVisitor = std::function<void(QByteArray const& key,
+                                           QByteArray const& record)>;
+
+  JsonRecordReader(QIODevice& device);
+
+  /// Calls `visitor` for every element of every top level array, in file
+  /// order. Other top level values are skipped. Throws std::logic_error on
+  /// malformed input.
+  void
+  read(RecordVisitor const& visitor);
+
+private:
+
+  bool
+  atEnd();
+
+  char
+  peek();
+
+  char
+  get();
+
+  void
+  expect(char c);
+
+  void
+  skipWhitespace();
+
+  /// Appends the raw text of the value to `out`, skips it if null
+  void
+  readValue(QByteArray* out);
+
+  void
+  readString(QByteArray* out);
+
+private:
+
+  QIODevice& _device;
+
+  QByteArray _buffer;
+
+  int _pos = 0;
+};
+}
@@ -11,6 +11,7 @@
 
 #include "ConnectionGraphicsObject.hpp"
 #include "ConnectionState.hpp"
+#include "Connection.hpp"
 
 namespace QtNodes {
 
@@ -20,8 +21,10 @@ Node(std::unique_ptr<NodeDataModel> && dataModel, QUuid const& id)
   , _index(id), anchorInit(false)
 {
   // propagate data: model => node
+  // direct, a queued call would read outData again after the executor
+  // already delivered it, racing the worker that computes the node
   connect(_nodeDataModel.get(), &NodeDataModel::dataUpdated,
-          this, &Node::onDataUpdated);
+          this, &Node::onDataUpdated, Qt::DirectConnection);
 
   _inConnections.resize(nodeDataModel()->nPorts(PortType::In));
   _outConnections.resize(nodeDataModel()->nPorts(PortType::Out));
@@ -137,6 +140,41 @@ connections(PortType pType, PortIndex idx)
   return pType == PortType::In ? _inConnections[idx] : _outConnections[idx];
 }
 
+
+void
+Node::
+attachConnection(PortType pType, PortIndex idx, Connection* connection)
+{
+  auto& list = connections(pType, idx);
+
+  std::size_t& slot = (pType == PortType::In) ? connection->_inSlot : connection->_outSlot;
+
+  slot = list.size();
+  list.push_back(connection);
+}
+
+
+void
+Node::
+detachConnection(PortType pType, PortIndex idx, Connection* connection)
+{
+  auto& list = connections(pType, idx);
+
+  auto slotOf = [pType](Connection* c) -> std::size_t&
+  {
+    return (pType == PortType::In) ? c->_inSlot : c->_outSlot;
+  };
+
+  std::size_t const slot = slotOf(connection);
+
+  Q_ASSERT(slot < list.size() && list[slot] == connection);
+
+  list[slot] = list.back();
+  slotOf(list[slot]) = slot;
+
+  list.pop_back();
+}
+
 void
 Node::
 propagateData(std::shared_ptr<NodeData> nodeData,
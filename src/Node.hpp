@@ -78,6 +78,15 @@ public:
   std::vector<Connection*>&
   connections(PortType pType, PortIndex pIdx);
 
+  /// Appends `connection` to the list of the port
+  void
+  attachConnection(PortType pType, PortIndex pIdx, Connection* connection);
+
+  /// Takes `connection` out of the list of the port in O(1); the port's
+  /// last connection moves into its place
+  void
+  detachConnection(PortType pType, PortIndex pIdx, Connection* connection);
+
 public slots: // data propagation
 
   /// Propagates incoming data to the underlying model.
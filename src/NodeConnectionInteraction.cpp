@@ -6,6 +6,9 @@
 #include "DataModelRegistry.hpp"
 #include "FlowScene.hpp"
 
+#include <utility>
+#include <vector>
+
 namespace QtNodes {
 
 NodeConnectionInteraction::
@@ -17,7 +20,7 @@ NodeConnectionInteraction(NodeIndex const& node,
 
 bool
 NodeConnectionInteraction::
-canConnect(PortIndex &portIndex, bool& typeConversionNeeded, QString& converterModel) const
+canConnect(PortIndex &portIndex, bool& typeConversionNeeded) const
 {
   typeConversionNeeded = false;
 
@@ -48,7 +51,7 @@ canConnect(PortIndex &portIndex, bool& typeConversionNeeded, QString& converterM
   if (!nodePortIsEmpty(requiredPort, portIndex))
     return false;
 
-  // 4) Connection type equals node port type, or there is a registered type conversion that can translate between the two
+  // 4) Connection type equals node port type, or there is a chain of registered type conversions that can translate between the two
 
   auto connectionDataType = _connection->dataType();
 
@@ -56,13 +59,17 @@ canConnect(PortIndex &portIndex, bool& typeConversionNeeded, QString& converterM
   NodeDataType candidateNodeDataType = modelTarget->nodePortDataType(_node, requiredPort, portIndex);
 
   // if the types don't match, try a conversion
-  if (connectionDataType.id != candidateNodeDataType.id)
+  if (connectionDataType.atom() != candidateNodeDataType.atom())
   {
     if (requiredPort == PortType::In)
     {
-      return typeConversionNeeded = (converterModel = modelTarget->converterNode(connectionDataType, candidateNodeDataType)) != QString{};
+      typeConversionNeeded = modelTarget->canConvert(connectionDataType, candidateNodeDataType);
+    }
+    else
+    {
+      typeConversionNeeded = modelTarget->canConvert(candidateNodeDataType, connectionDataType);
     }
-    return typeConversionNeeded = (converterModel = modelTarget->converterNode(candidateNodeDataType, connectionDataType)) != QString{};
+    return typeConversionNeeded;
   }
 
   return true;
@@ -77,13 +84,13 @@ tryConnect() const
   PortIndex portIndex = INVALID;
   bool typeConversionNeeded = false;
 
-  QString typeConverterModel;
-  if (!canConnect(portIndex, typeConversionNeeded, typeConverterModel))
+  if (!canConnect(portIndex, typeConversionNeeded))
   {
     return false;
   }
   
-  auto model = _connection->flowScene().model();
+  auto& scene = _connection->flowScene();
+  auto model = scene.model();
   
   
   //Determining port types
@@ -96,50 +103,91 @@ tryConnect() const
   
   auto outNodePortIndex = _connection->portIndex(connectedPort);
   
-  /// 1.5) If the connection is possible but a type conversion is needed, add a converter node to the scene, and connect it properly
+  /// 1.5) If the connection is possible but a type conversion is needed, add the converter nodes to the scene, and connect them properly
   if (typeConversionNeeded)
   {
+    //Data flows from the source port through the converters into the sink port.
+    //Which end the user started dragging from decides which one is ours.
+    NodeIndex sourceNode = outNode;
+    PortIndex sourcePortIndex = outNodePortIndex;
+    NodeIndex sinkNode = _node;
+    PortIndex sinkPortIndex = portIndex;
+
+    if (requiredPort == PortType::Out)
+    {
+      std::swap(sourceNode, sinkNode);
+      std::swap(sourcePortIndex, sinkPortIndex);
+    }
 
-    
-    // try to create the converter  node
-    QUuid newNodeID = model->addNode(typeConverterModel, QPointF{});
-    if (!newNodeID.isNull()) {
-      // node was created!
-      NodeIndex converterNode = model->nodeIndex(newNodeID);
-      
-      // get the graphics object
-      auto convertedGraphics = _connection->flowScene().nodeGraphicsObject(converterNode);
-      Q_ASSERT(convertedGraphics);
-      
-      auto thisNodeGraphics = _connection->flowScene().nodeGraphicsObject(_node);
-      
-      auto outGraphics = _connection->flowScene().nodeGraphicsObject(outNode);
-      
-      // move it
-      auto converterNodePos = NodeGeometry::calculateNodePositionBetweenNodePorts(portIndex, requiredPort, *thisNodeGraphics, outNodePortIndex, connectedPort, *outGraphics, convertedGraphics->geometry());
-      
-      // if this fails, well at least we tried--keep on going
-      model->moveNode(converterNode, converterNodePos);
-      
-      // connect it in all the right places
-      
-      //The connection order is different based on if the users connection was started from an input port, or an output port.
-      if (requiredPort == PortType::In)
+    QStringList const typeConverterModels =
+      model->converterNodes(model->nodePortDataType(sourceNode, PortType::Out, sourcePortIndex),
+                            model->nodePortDataType(sinkNode, PortType::In, sinkPortIndex));
+
+    // canConvert() and converterNodes() disagree
+    if (typeConverterModels.isEmpty())
+      return false;
+
+    // the whole chain shows up in the scene at once
+    scene.beginDeferredUpdates();
+
+    std::vector<NodeIndex> converterNodes;
+    for (auto const& typeConverterModel : typeConverterModels)
+    {
+      QUuid newNodeID = model->addNode(typeConverterModel, QPointF{});
+      if (newNodeID.isNull())
+        break;
+
+      converterNodes.push_back(model->nodeIndex(newNodeID));
+    }
+
+    bool const created = converterNodes.size() == static_cast<std::size_t>(typeConverterModels.size());
+
+    if (created)
+    {
+      // connect them in all the right places
+      // hopefully this works...don't fail even if it doesn't
+      NodeIndex previousNode = sourceNode;
+      PortIndex previousPortIndex = sourcePortIndex;
+      for (auto const& converterNode : converterNodes)
       {
-        // hopefully this works...don't fail even if it doesn't
-        model->addConnection(converterNode, 0, _node, portIndex);
-        model->addConnection(outNode, outNodePortIndex, converterNode, 0);
+        model->addConnection(previousNode, previousPortIndex, converterNode, 0);
+
+        previousNode = converterNode;
+        previousPortIndex = 0;
       }
-      else
+      model->addConnection(previousNode, previousPortIndex, sinkNode, sinkPortIndex);
+    }
+    else
+    {
+      // couln't create one of the nodes, don't leave half a chain behind
+      for (auto const& converterNode : converterNodes)
       {
-        // hopefully this works...don't fail even if it doesn't
-        model->addConnection(converterNode, 0, outNode, outNodePortIndex);
-        model->addConnection(_node, portIndex, converterNode, 0);
+        model->removeNodeWithConnections(converterNode);
       }
+    }
+
+    scene.endDeferredUpdates();
 
-    } else {
-      // couln't create the node
+    if (!created)
       return false;
+
+    // spread them out evenly between the ports, now that they have a size
+    auto sourceGraphics = scene.nodeGraphicsObject(sourceNode);
+    auto sinkGraphics = scene.nodeGraphicsObject(sinkNode);
+
+    for (std::size_t i = 0; i < converterNodes.size(); ++i)
+    {
+      auto convertedGraphics = scene.nodeGraphicsObject(converterNodes[i]);
+      Q_ASSERT(convertedGraphics);
+
+      double const fraction = double(i + 1) / double(converterNodes.size() + 1);
+
+      auto converterNodePos = NodeGeometry::calculateNodePositionBetweenNodePorts(sinkPortIndex, PortType::In, *sinkGraphics,
+                                                                                  sourcePortIndex, PortType::Out, *sourceGraphics,
+                                                                                  convertedGraphics->geometry(), fraction);
+
+      // if this fails, well at least we tried--keep on going
+      model->moveNode(converterNodes[i], converterNodePos);
     }
 
     return true;
@@ -212,16 +260,15 @@ NodeConnectionInteraction::
 nodePortIndexUnderScenePoint(PortType portType,
                              QPointF const & scenePoint) const
 {
-  NodeGraphicsObject const& ngo = *_connection->flowScene().nodeGraphicsObject(_node);
-  NodeGeometry const &nodeGeom = ngo.geometry();
+  FlowScene const& scene = _connection->flowScene();
+
+  auto hit = scene.portAt(scenePoint, portType);
 
-  QTransform sceneTransform =
-    ngo.sceneTransform();
+  // covered by the port of a node stacked above this one
+  if (hit.first != scene.nodeGraphicsObject(_node))
+    return INVALID;
 
-  PortIndex portIndex = nodeGeom.checkHitScenePoint(portType,
-                                                    scenePoint,
-                                                    sceneTransform);
-  return portIndex;
+  return hit.second;
 }
 
 
@@ -2,6 +2,8 @@
 
 #include <memory>
 
+#include <QtCore/QStringList>
+
 #include "NodeIndex.hpp"
 #include "PortType.hpp"
 #include "ConnectionGraphicsObject.hpp"
@@ -22,13 +24,12 @@ public:
   /// 1) Connection 'requires' a port
   /// 2) Connection's vacant end is above the node port
   /// 3) Node port is vacant
-  /// 4) Connection type equals node port type, or there is a registered type conversion that can translate between the two
+  /// 4) Connection type equals node port type, or there is a chain of registered type conversions that can translate between the two
   bool canConnect(PortIndex &portIndex, 
-                  bool& typeConversionNeeded,
-                  QString& converterModel) const;
+                  bool& typeConversionNeeded) const;
 
   /// 1)   Check conditions from 'canConnect'
-  /// 1.5) If the connection is possible but a type conversion is needed, add a converter node to the scene, and connect it properly
+  /// 1.5) If the connection is possible but a type conversion is needed, add the chain of converter nodes to the scene, and connect it properly
   /// 2)   Assign node to required port in Connection
   /// 3)   Assign Connection to empty port in NodeState
   /// 4)   Adjust Connection geometry
@@ -1,16 +1,49 @@
 #pragma once
 
+#include <utility>
+
 #include <QtCore/QString>
 
 #include "Export.hpp"
+#include "Atom.hpp"
 
 namespace QtNodes
 {
 
 struct NodeDataType
 {
+  NodeDataType() = default;
+
+  NodeDataType(QString typeId, QString typeName)
+    : id(std::move(typeId))
+    , name(std::move(typeName))
+  {
+    _atom = Atom::intern(id);
+    _atomData = id.constData();
+  }
+
   QString id;
   QString name;
+
+  /// Interned `id`, compare these instead of the strings. Known from
+  /// construction on; if `id` is assigned later the string is interned
+  /// again on every call.
+  Atom
+  atom() const
+  {
+    if (_atomData != nullptr && _atomData == id.constData())
+      return _atom;
+
+    return Atom(id);
+  }
+
+private:
+
+  Atom _atom;
+
+  // data of the interned `id`, the table keeps it alive so a reassigned
+  // `id` can never point here again
+  QChar const* _atomData = nullptr;
 };
 
 /// Class represents data transferred between nodes.
@@ -24,7 +57,7 @@ public:
 
   virtual bool sameType(NodeData const &nodeData) const
   {
-    return (this->type().id == nodeData.type().id);
+    return (this->type().atom() == nodeData.type().atom());
   }
 
   /// Type for inner use
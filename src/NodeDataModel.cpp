@@ -1,18 +1,31 @@
 #include "NodeDataModel.hpp"
 
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+#include <QtConcurrent/QtConcurrentRun>
+
 #include "StyleCollection.hpp"
 
 using QtNodes::NodeDataModel;
 using QtNodes::NodeStyle;
+using QtNodes::CancellationToken;
 
 NodeDataModel::
 NodeDataModel()
-  : _nodeStyle(StyleCollection::nodeStyle())
 {
   // Derived classes can initialize specific style here
 }
 
 
+NodeDataModel::
+~NodeDataModel()
+{
+  // work still running on the pool sees this and can bail out
+  _computation.cancel();
+}
+
+
 QJsonObject
 NodeDataModel::
 save() const
@@ -29,7 +42,7 @@ NodeStyle const&
 NodeDataModel::
 nodeStyle() const
 {
-  return _nodeStyle;
+  return _nodeStyle ? *_nodeStyle : StyleCollection::nodeStyle();
 }
 
 
@@ -37,5 +50,102 @@ void
 NodeDataModel::
 setNodeStyle(NodeStyle const& style)
 {
-  _nodeStyle = style;
+  _nodeStyle = std::make_shared<NodeStyle const>(style);
+
+  emit styleUpdated();
+}
+
+
+void
+NodeDataModel::
+cancelComputation()
+{
+  if (!_computing)
+    return;
+
+  _computation.cancel();
+
+  endComputation();
+}
+
+
+void
+NodeDataModel::
+startComputation(std::function<void(CancellationToken const&)> work,
+                 std::function<void()> continuation)
+{
+  // the watcher and the token belong to the model's thread
+  if (QThread::currentThread() != thread())
+  {
+    QTimer::singleShot(0, this, [this, work, continuation]
+                       { startComputation(work, continuation); });
+    return;
+  }
+
+  CancellationToken token = beginComputation();
+
+  auto watcher = new QFutureWatcher<void>(this);
+
+  connect(watcher, &QFutureWatcherBase::finished, this,
+          [this, watcher, token, continuation]
+          {
+            watcher->deleteLater();
+
+            // superseded by a newer computation
+            if (token.isCancelled())
+              return;
+
+            continuation();
+
+            endComputation();
+          });
+
+  watcher->setFuture(QtConcurrent::run([work, token] { work(token); }));
+}
+
+
+CancellationToken
+NodeDataModel::
+beginComputation()
+{
+  _computation.cancel();
+
+  _computation = CancellationToken();
+
+  if (!_computing)
+  {
+    _computing = true;
+
+    enterComputing();
+  }
+
+  return _computation;
+}
+
+
+void
+NodeDataModel::
+endComputation()
+{
+  _computing = false;
+
+  leaveComputing();
+}
+
+
+void
+NodeDataModel::
+enterComputing()
+{
+  if (_computingDepth.fetch_add(1) == 0)
+    emit computingStarted();
+}
+
+
+void
+NodeDataModel::
+leaveComputing()
+{
+  if (_computingDepth.fetch_sub(1) == 1)
+    emit computingFinished();
 }
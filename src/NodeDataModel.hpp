@@ -1,6 +1,9 @@
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <utility>
 
 #include <QtWidgets/QWidget>
 
@@ -12,6 +15,7 @@
 #include "NodePainterDelegate.hpp"
 #include "Export.hpp"
 #include "FlowSceneModel.hpp"
+#include "CancellationToken.hpp"
 
 namespace QtNodes
 {
@@ -29,9 +33,10 @@ public:
   NodeDataModel();
 
   virtual
-  ~NodeDataModel() = default;
+  ~NodeDataModel();
 
-  /// Caption is used in GUI
+  /// Caption is used in GUI. Views keep it with the node's layout, emit
+  /// captionUpdated() when it changes.
   virtual QString
   caption() const = 0;
 
@@ -80,9 +85,14 @@ public:
     return ConnectionPolicy::Many;
   }
 
+  /// The style set with setNodeStyle(), else the global one
   NodeStyle const&
   nodeStyle() const;
 
+  /// Null unless setNodeStyle() was called
+  NodeStyleHandle const&
+  nodeStyleHandle() const { return _nodeStyle; }
+
   void
   setNodeStyle(NodeStyle const& style);
   
@@ -117,6 +127,78 @@ public:
   virtual
   NodePainterDelegate* painterDelegate() const { return nullptr; }
 
+  /// With parallel execution enabled, setInData() and outData() of models
+  /// returning true are called on a worker thread. They must not touch the
+  /// embedded widget there; update it from computingFinished() instead,
+  /// which is emitted on the GUI thread.
+  virtual
+  bool
+  threadSafe() const { return false; }
+
+public:
+
+  /// True while a computation started with computeAsync() is running
+  bool
+  isComputing() const { return _computing; }
+
+  /// Drops the running asynchronous computation, its continuation
+  /// is not called
+  void
+  cancelComputation();
+
+protected:
+
+  /// Runs `work(CancellationToken)` on the global thread pool and calls
+  /// `continuation(result)` on the model's thread when it is done.
+  ///
+  /// Latest wins: starting a computation cancels the one in flight, whose
+  /// token then reports isCancelled() and whose result is discarded. Call
+  /// this from setInData() with a copy of the inputs, then set the output
+  /// and emit dataUpdated() from the continuation. `work` runs off the GUI
+  /// thread and must not capture the model or its widgets. computingStarted()
+  /// and computingFinished() bracket a burst of superseding computations.
+  ///
+  /// Called on another thread, e.g. from setInData() of a threadSafe() model
+  /// run by the parallel executor, the computation is started from the
+  /// model's event loop instead.
+  template<typename Work, typename Continuation>
+  void
+  computeAsync(Work work, Continuation continuation)
+  {
+    using Result = decltype(work(std::declval<CancellationToken const&>()));
+
+    auto result = std::make_shared<std::unique_ptr<Result>>();
+
+    startComputation([work, result](CancellationToken const& token)
+                     { result->reset(new Result(work(token))); },
+                     [continuation, result]
+                     { continuation(std::move(**result)); });
+  }
+
+private:
+
+  friend class DataFlowExecutor;
+
+  /// Type erased computeAsync()
+  void
+  startComputation(std::function<void(CancellationToken const&)> work,
+                   std::function<void()> continuation);
+
+  CancellationToken
+  beginComputation();
+
+  void
+  endComputation();
+
+  /// computingStarted() and computingFinished() are only emitted from
+  /// here, when the outermost of the executor's and computeAsync()'s
+  /// nested brackets opens and closes
+  void
+  enterComputing();
+
+  void
+  leaveComputing();
+
 signals:
 
   void
@@ -125,6 +207,14 @@ signals:
   void
   dataInvalidated(PortIndex index);
 
+  /// Emit when caption() changes, so views can lay the node out again
+  void
+  captionUpdated();
+
+  /// Emitted by setNodeStyle()
+  void
+  styleUpdated();
+
   void
   computingStarted();
 
@@ -133,6 +223,14 @@ signals:
 
 private:
 
-  NodeStyle _nodeStyle;
+  NodeStyleHandle _nodeStyle;
+
+  // only touched on the model's thread
+  CancellationToken _computation;
+
+  bool _computing = false;
+
+  // the executor enters on worker threads
+  std::atomic<int> _computingDepth{0};
 };
 }
@@ -9,13 +9,14 @@
 #include "FlowSceneModel.hpp"
 
 #include "StyleCollection.hpp"
+#include "StaticTextCache.hpp"
 
 #include <QWidget>
 
 namespace QtNodes {
 
 NodeGeometry::
-NodeGeometry(const NodeIndex& index)
+NodeGeometry(const NodeIndex& index, QFont const& font)
   : _width(100)
   , _height(150)
   , _inputPortWidth(70)
@@ -27,12 +28,10 @@ NodeGeometry(const NodeIndex& index)
   , _nSinks(index.model()->nodePortCount(index, PortType::In))
   , _draggingPos(-1000, -1000)
   , _nodeIndex(index)
-  , _fontMetrics(QFont())
-  , _boldFontMetrics(QFont())
+  , _font(font)
+  , _fontMetrics(font)
+  , _style(index.model()->nodeStyleHandle(index))
 {
-  QFont f; f.setBold(true);
-
-  _boldFontMetrics = QFontMetrics(f);
 }
 
 
@@ -53,14 +52,26 @@ QRectF
 NodeGeometry::
 boundingRect() const
 {
-  auto const &nodeStyle = _nodeIndex.model()->nodeStyle(_nodeIndex);
+  double addon = 4 * style().ConnectionPointDiameter;
 
-  double addon = 4 * nodeStyle.ConnectionPointDiameter;
+  QRectF rect(0 - addon,
+              0 - addon,
+              _width + 2 * addon,
+              _height + 2 * addon);
 
-  return QRectF(0 - addon,
-                0 - addon,
-                _width + 2 * addon,
-                _height + 2 * addon);
+  // a graphics effect grows the item by itself, a painted shadow doesn't
+  if (style().Shadow == NodeStyle::ShadowMode::Painted)
+  {
+    double const diam = style().ConnectionPointDiameter;
+    double const blur = NodeStyle::ShadowBlurRadius;
+
+    QRectF shadow(-diam, -diam, 2.0 * diam + _width, 2.0 * diam + _height);
+
+    rect |= shadow.translated(NodeStyle::ShadowOffset, NodeStyle::ShadowOffset)
+                  .adjusted(-blur, -blur, blur, blur);
+  }
+
+  return rect;
 }
 
 
@@ -68,15 +79,58 @@ void
 NodeGeometry::
 recalculateSize() const
 {
+  FlowSceneModel const& model = *_nodeIndex.model();
+
+  _style = model.nodeStyleHandle(_nodeIndex);
+
   _entryHeight = _fontMetrics.height();
 
+  QFont boldFont = _font;
+  boldFont.setBold(true);
+
+  _caption = model.nodeCaption(_nodeIndex);
+  {
+    QRect rect = StaticTextCache::entry(_caption, boldFont).boundingRect;
+    _captionWidth  = rect.width();
+    _captionHeight = rect.height();
+  }
+
+  auto measurePorts =
+    [&](PortType portType)
+    {
+      auto& ports = portLayouts(portType);
+
+      ports.resize(model.nodePortCount(_nodeIndex, portType));
+
+      for (size_t i = 0; i < ports.size(); ++i)
+      {
+        QString label = model.nodePortCaption(_nodeIndex, portType, i);
+
+        if (label.isEmpty())
+        {
+          label = model.nodePortDataType(_nodeIndex, portType, i).name;
+        }
+
+        auto entry = StaticTextCache::entry(label, _font);
+
+        ports[i].labelRect    = entry.boundingRect;
+        ports[i].labelAdvance = entry.advance;
+        ports[i].label        = std::move(label);
+      }
+    };
+
+  measurePorts(PortType::In);
+  measurePorts(PortType::Out);
+
   {
     unsigned int maxNumOfEntries = std::max(_nSinks, _nSources);
     unsigned int step = _entryHeight + _spacing;
     _height = step * maxNumOfEntries;
   }
 
-  if (auto w = _nodeIndex.model()->nodeWidget(_nodeIndex))
+  auto w = model.nodeWidget(_nodeIndex);
+
+  if (w)
   {
     _height = std::max(_height, static_cast<unsigned>(w->height()));
   }
@@ -90,18 +144,38 @@ recalculateSize() const
            _outputPortWidth +
            2 * _spacing;
 
-  if (auto w = _nodeIndex.model()->nodeWidget(_nodeIndex))
+  if (w)
   {
     _width += w->width();
   }
 
   _width = std::max(_width, captionWidth());
 
-  if (_nodeIndex.model()->nodeValidationState(_nodeIndex) != NodeValidationState::Valid)
+  if (model.nodeValidationState(_nodeIndex) != NodeValidationState::Valid)
   {
+    QRect rect = StaticTextCache::entry(model.nodeValidationMessage(_nodeIndex), boldFont).boundingRect;
+    _validationWidth  = rect.width();
+    _validationHeight = rect.height();
+
     _width   = std::max(_width, validationWidth());
     _height += validationHeight() + _spacing;
   }
+  else
+  {
+    _validationWidth  = 0;
+    _validationHeight = 0;
+  }
+
+  // positions depend on the final width
+  for (auto portType : { PortType::In, PortType::Out })
+  {
+    auto& ports = portLayouts(portType);
+
+    for (size_t i = 0; i < ports.size(); ++i)
+    {
+      ports[i].position = calculatePortPosition(i, portType);
+    }
+  }
 }
 
 
@@ -109,20 +183,30 @@ void
 NodeGeometry::
 recalculateSize(QFont const & font) const
 {
-  QFontMetrics fontMetrics(font);
-  QFont boldFont = font;
+  if (font == _font)
+    return;
 
-  boldFont.setBold(true);
+  _font = font;
 
-  QFontMetrics boldFontMetrics(boldFont);
+  _fontMetrics = QFontMetrics(font);
 
-  if (_boldFontMetrics != boldFontMetrics)
-  {
-    _fontMetrics     = fontMetrics;
-    _boldFontMetrics = boldFontMetrics;
+  recalculateSize();
+}
 
-    recalculateSize();
-  }
+
+QString const&
+NodeGeometry::
+portLabel(PortType portType, PortIndex index) const
+{
+  return portLayouts(portType)[index].label;
+}
+
+
+QRect const&
+NodeGeometry::
+portLabelRect(PortType portType, PortIndex index) const
+{
+  return portLayouts(portType)[index].labelRect;
 }
 
 
@@ -132,7 +216,20 @@ portScenePosition(int index,
                   PortType portType,
                   QTransform t) const
 {
-  auto const &nodeStyle = _nodeIndex.model()->nodeStyle(_nodeIndex);
+  auto const& ports = portLayouts(portType);
+
+  if (index >= 0 && static_cast<size_t>(index) < ports.size())
+    return t.map(ports[index].position);
+
+  return t.map(calculatePortPosition(index, portType));
+}
+
+
+QPointF
+NodeGeometry::
+calculatePortPosition(PortIndex index, PortType portType) const
+{
+  auto const &nodeStyle = style();
 
   unsigned int step = _entryHeight + _spacing;
 
@@ -169,7 +266,7 @@ portScenePosition(int index,
       break;
   }
 
-  return t.map(result);
+  return result;
 }
 
 
@@ -187,6 +284,7 @@ checkHitScenePoint(PortType portType,
     return result;
 
   double const tolerance = 2.0 * nodeStyle.ConnectionPointDiameter;
+  double const toleranceSquared = tolerance * tolerance;
 
   size_t const nItems = _nodeIndex.model()->nodePortCount(_nodeIndex, portType);
 
@@ -195,9 +293,8 @@ checkHitScenePoint(PortType portType,
     auto pp = portScenePosition(i, portType, sceneTransform);
 
     QPointF p = pp - scenePoint;
-    auto    distance = std::sqrt(QPointF::dotProduct(p, p));
 
-    if (distance < tolerance)
+    if (QPointF::dotProduct(p, p) < toleranceSquared)
     {
       result = PortIndex(i);
       break;
@@ -241,35 +338,11 @@ widgetPosition() const
 }
 
 
-unsigned int
-NodeGeometry::
-captionHeight() const
-{
-
-  QString name = _nodeIndex.model()->nodeCaption(_nodeIndex);
-
-  return _boldFontMetrics.boundingRect(name).height();
-}
-
-
-unsigned int
-NodeGeometry::
-captionWidth() const
-{
-
-  QString name = _nodeIndex.model()->nodeCaption(_nodeIndex);
-
-  return _boldFontMetrics.boundingRect(name).width();
-}
-
-
 unsigned int
 NodeGeometry::
 validationHeight() const
 {
-  QString msg = _nodeIndex.model()->nodeValidationMessage(_nodeIndex);
-
-  return _boldFontMetrics.boundingRect(msg).height();
+  return _validationHeight;
 }
 
 
@@ -277,9 +350,7 @@ unsigned int
 NodeGeometry::
 validationWidth() const
 {
-  QString msg = _nodeIndex.model()->nodeValidationMessage(_nodeIndex);
-
-  return _boldFontMetrics.boundingRect(msg).width();
+  return _validationWidth;
 }
 
 
@@ -287,14 +358,16 @@ QPointF
 NodeGeometry::
 calculateNodePositionBetweenNodePorts(PortIndex targetPortIndex, PortType targetPort, const NodeGraphicsObject& targetNode, 
                                       PortIndex sourcePortIndex, PortType sourcePort, const NodeGraphicsObject& sourceNode, 
-                                      const NodeGeometry& newNodeGeom)
+                                      const NodeGeometry& newNodeGeom, double fraction)
 {
-  //Calculating the nodes position in the scene. It'll be positioned half way between the two ports that it "connects". 
-  //The first line calculates the halfway point between the ports (node position + port position on the node for both nodes averaged).
-  //The second line offsets this coordinate with the size of the new node, so that the new nodes center falls on the originally
+  //Calculating the nodes position in the scene. It'll be positioned `fraction` of the way between the two ports that it "connects",
+  //half way by default.
+  //The first lines interpolate between the ports (node position + port position on the node for both nodes).
+  //The rest offsets this coordinate with the size of the new node, so that the new nodes center falls on the originally
   //calculated coordinate, instead of it's upper left corner.
-  auto converterNodePos = (sourceNode.pos() + sourceNode.geometry().portScenePosition(sourcePortIndex, sourcePort) 
-    + targetNode.pos() + targetNode.geometry().portScenePosition(targetPortIndex, targetPort)) / 2.0f;
+  auto sourcePos = sourceNode.pos() + sourceNode.geometry().portScenePosition(sourcePortIndex, sourcePort);
+  auto targetPos = targetNode.pos() + targetNode.geometry().portScenePosition(targetPortIndex, targetPort);
+  auto converterNodePos = sourcePos + (targetPos - sourcePos) * fraction;
   converterNodePos.setX(converterNodePos.x() - newNodeGeom.width() / 2.0f);
   converterNodePos.setY(converterNodePos.y() - newNodeGeom.height() / 2.0f);
   return converterNodePos;
@@ -307,17 +380,9 @@ portWidth(PortType portType) const
 {
   unsigned width = 0;
 
-  for (auto i = 0ul; i < _nodeIndex.model()->nodePortCount(_nodeIndex, portType); ++i)
+  for (auto const& port : portLayouts(portType))
   {
-    QString name = _nodeIndex.model()->nodePortCaption(_nodeIndex, portType, i);
-
-    if (name.isEmpty())
-    {
-      name = _nodeIndex.model()->nodePortDataType(_nodeIndex, portType, i).name;
-    }
-
-    width = std::max(unsigned(_fontMetrics.width(name)),
-                     width);
+    width = std::max(port.labelAdvance, width);
   }
 
   return width;
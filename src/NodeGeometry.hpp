@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include <QtCore/QRectF>
 #include <QtCore/QPointF>
@@ -10,6 +11,7 @@
 #include "PortType.hpp"
 #include "Export.hpp"
 #include "NodeIndex.hpp"
+#include "NodeStyle.hpp"
 
 namespace QtNodes
 {
@@ -20,7 +22,7 @@ class NODE_EDITOR_PUBLIC NodeGeometry
 {
 public:
 
-  NodeGeometry(const NodeIndex& index);
+  NodeGeometry(const NodeIndex& index, QFont const& font);
 
 public:
   unsigned int
@@ -80,14 +82,39 @@ public:
   QRectF
   boundingRect() const;
 
-  /// Updates size unconditionally
+  /// Rebuilds the cached layout unconditionally. Needed whenever the
+  /// caption, validation state or embedded widget size changes; port
+  /// changes recreate the whole NodeGraphicsObject.
   void
   recalculateSize() const;
 
-  /// Updates size if the QFontMetrics is changed
+  /// Rebuilds the cached layout if the font changed
   void
   recalculateSize(QFont const &font) const;
 
+  /// The font the layout was measured with, and the node is painted in
+  QFont const&
+  font() const { return _font; }
+
+  /// Cached at construction and by recalculateSize()
+  NodeStyle const&
+  style() const { return *_style; }
+
+  /// Cached caption, as measured with the bold font
+  QString const&
+  caption() const { return _caption; }
+
+  unsigned int
+  captionWidth() const { return _captionWidth; }
+
+  /// Cached port label, the caption or else the data type name
+  QString const&
+  portLabel(PortType portType, PortIndex index) const;
+
+  /// Bounding rect of portLabel() in the current font
+  QRect const&
+  portLabelRect(PortType portType, PortIndex index) const;
+
   // TODO removed default QTransform()
   QPointF
   portScenePosition(PortIndex index,
@@ -112,22 +139,35 @@ public:
   unsigned int
   validationWidth() const;
   
+  /// `fraction` of the way from the source port to the target port
   static 
   QPointF 
   calculateNodePositionBetweenNodePorts(PortIndex targetPortIndex, PortType targetPort, const NodeGraphicsObject& targetNode, 
                                       PortIndex sourcePortIndex, PortType sourcePort, const NodeGraphicsObject& sourceNode, 
-                                      const NodeGeometry& newNodeGeom);
+                                      const NodeGeometry& newNodeGeom, double fraction = 0.5);
 private:
 
-  unsigned int
-  captionHeight() const;
+  struct PortLayout
+  {
+    QString      label;
+    QRect        labelRect;
+    unsigned int labelAdvance;
+    QPointF      position;
+  };
+
+  std::vector<PortLayout>&
+  portLayouts(PortType portType) const
+  { return portType == PortType::In ? _inPorts : _outPorts; }
 
   unsigned int
-  captionWidth() const;
+  captionHeight() const { return _captionHeight; }
 
   unsigned int
   portWidth(PortType portType) const;
 
+  QPointF
+  calculatePortPosition(PortIndex index, PortType portType) const;
+
 private:
 
   // some variables are mutable because
@@ -152,7 +192,18 @@ private:
 
   NodeIndex _nodeIndex;
 
+  mutable QFont        _font;
   mutable QFontMetrics _fontMetrics;
-  mutable QFontMetrics _boldFontMetrics;
+
+  // layout cache, rebuilt by recalculateSize()
+  mutable NodeStyleHandle _style;
+  mutable QString      _caption;
+  mutable unsigned int _captionWidth = 0;
+  mutable unsigned int _captionHeight = 0;
+  mutable unsigned int _validationWidth = 0;
+  mutable unsigned int _validationHeight = 0;
+
+  mutable std::vector<PortLayout> _inPorts;
+  mutable std::vector<PortLayout> _outPorts;
 };
 }
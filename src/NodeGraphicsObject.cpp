@@ -26,7 +26,7 @@ NodeGraphicsObject::
 NodeGraphicsObject(FlowScene& scene, const NodeIndex& index)
   : _scene(scene)
   , _nodeIndex(index)
-  , _geometry(index)
+  , _geometry(index, scene.font())
   , _state(index)
   , _locked(false)
   , _proxyWidget(nullptr)
@@ -41,18 +41,8 @@ NodeGraphicsObject(FlowScene& scene, const NodeIndex& index)
 
   setCacheMode( QGraphicsItem::DeviceCoordinateCache );
 
-  auto const &nodeStyle = index.model()->nodeStyle(index);
-
-  {
-    auto effect = new QGraphicsDropShadowEffect;
-    effect->setOffset(4, 4);
-    effect->setBlurRadius(20);
-    effect->setColor(nodeStyle.ShadowColor);
-
-    setGraphicsEffect(effect);
-  }
-
-  setOpacity(nodeStyle.Opacity);
+  // sets the shadow up as well
+  applyStyle();
 
   setAcceptHoverEvents(true);
 
@@ -63,6 +53,9 @@ NodeGraphicsObject(FlowScene& scene, const NodeIndex& index)
   // connect to the move signals
   auto onMoveSlot = [this] {
 
+    // dragged nodes are reported once per mouse move by FlowScene::flushNodeDrag()
+    if (_scene._nodeDrag.anchor != nullptr) return;
+
     // ask the model to move it
     if (!flowScene().model()->moveNode(_nodeIndex, pos())) {
       // set the location back
@@ -225,6 +218,40 @@ resetReactionToConnection()
   update();
 }
 
+void
+NodeGraphicsObject::
+applyStyle()
+{
+  auto const &nodeStyle = _geometry.style();
+
+  auto effect = qobject_cast<QGraphicsDropShadowEffect*>(graphicsEffect());
+
+  if (nodeStyle.Shadow == NodeStyle::ShadowMode::Effect)
+  {
+    if (!effect)
+    {
+      effect = new QGraphicsDropShadowEffect;
+      effect->setOffset(NodeStyle::ShadowOffset, NodeStyle::ShadowOffset);
+      effect->setBlurRadius(NodeStyle::ShadowBlurRadius);
+
+      setGraphicsEffect(effect);
+    }
+
+    effect->setColor(nodeStyle.ShadowColor);
+  }
+  else if (effect)
+  {
+    // NodePainter draws the shadow, or there is none
+    setGraphicsEffect(nullptr);
+  }
+
+  // the painted shadow changes the bounding rect
+  prepareGeometryChange();
+  _scene._spatialIndex.update(this);
+
+  setOpacity(nodeStyle.Opacity);
+}
+
 void NodeGraphicsObject::lock(bool locked)
 {
   _locked = locked;
@@ -242,7 +269,8 @@ paint(QPainter * painter,
 {
   painter->setClipRect(option->exposedRect);
 
-  NodePainter::paint(painter, *this);
+  NodePainter::paint(painter, *this,
+                     option->levelOfDetailFromTransform(painter->worldTransform()));
 }
 
 
@@ -250,9 +278,13 @@ QVariant
 NodeGraphicsObject::
 itemChange(GraphicsItemChange change, const QVariant &value)
 {
-  if (change == ItemPositionChange && scene())
+  if (change == ItemScenePositionHasChanged)
   {
-    moveConnections();
+    _scene._spatialIndex.update(this);
+
+    // a drag moves the connections of all dragged nodes at once
+    if (_scene._nodeDrag.anchor == nullptr)
+      moveConnections();
   }
 
   return QGraphicsItem::itemChange(change, value);
@@ -377,6 +409,7 @@ mouseMoveEvent(QGraphicsSceneMouseEvent * event)
       _proxyWidget->setPos(_geometry.widgetPosition());
 
       _geometry.recalculateSize();
+      _scene._spatialIndex.update(this);
       update();
 
       moveConnections();
@@ -386,10 +419,13 @@ mouseMoveEvent(QGraphicsSceneMouseEvent * event)
   }
   else
   {
+    if (flags() & QGraphicsItem::ItemIsMovable)
+      _scene.beginNodeDrag(*this);
+
+    // moves this node and the other selected ones
     QGraphicsObject::mouseMoveEvent(event);
 
-    if (event->lastPos() != event->pos())
-      moveConnections();
+    _scene.flushNodeDrag();
 
     event->ignore();
   }
@@ -414,6 +450,8 @@ mouseReleaseEvent(QGraphicsSceneMouseEvent* event)
     node->setAnchorInit(false);
   }
 
+  _scene.endNodeDrag();
+
   QGraphicsObject::mouseReleaseEvent(event);
 
   // position connections precisely after fast node move
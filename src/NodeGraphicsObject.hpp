@@ -65,6 +65,10 @@ public:
   void
   resetReactionToConnection();
 
+  /// Applies opacity and shadow color of geometry().style()
+  void
+  applyStyle();
+
   
   enum { Type = UserType + 1 };
 
@@ -3,6 +3,14 @@
 #include <cmath>
 
 #include <QtCore/QMargins>
+#include <QtCore/QtMath>
+#include <QtGui/QImage>
+#include <QtGui/QPixmap>
+#include <QtGui/QPixmapCache>
+#include <QtWidgets/QGraphicsEffect>
+#include <QtWidgets/QGraphicsPixmapItem>
+#include <QtWidgets/QGraphicsScene>
+#include <QtWidgets/qdrawutil.h>
 
 #include "StyleCollection.hpp"
 #include "PortType.hpp"
@@ -13,28 +21,108 @@
 #include "FlowSceneModel.hpp"
 #include "NodePainterDelegate.hpp"
 #include "FlowScene.hpp"
+#include "StaticTextCache.hpp"
 
 namespace QtNodes {
 
+namespace {
+// below this scale text is too small to read, only boxes and ports are drawn
+constexpr double SimplifiedDetail = 0.5;
+
+// below this scale a node is a few pixels wide, it is a flat rectangle
+constexpr double FlatDetail = 0.2;
+
+constexpr double NodeCornerRadius = 3.0;
+
+/// Shadow of a small rounded node rectangle. Cut into nine patches, its
+/// corners and edges fit a node of any size: the blur never reaches the
+/// single pixel in the middle, which is stretched over the inside.
+QPixmap
+shadowPixmap(QColor const& color, int& margin)
+{
+  int const blur = qCeil(NodeStyle::ShadowBlurRadius);
+
+  margin = 2 * blur + qCeil(NodeCornerRadius);
+
+  // bounded by the application's pixmap cache limit
+  QString const key = QStringLiteral("QtNodes::shadow:%1").arg(color.rgba(), 8, 16, QLatin1Char('0'));
+
+  QPixmap pixmap;
+  if (QPixmapCache::find(key, &pixmap))
+    return pixmap;
+
+  int const side = 2 * margin + 1;
+
+  QPixmap source(side, side);
+  source.fill(Qt::transparent);
+  {
+    QPainter p(&source);
+    p.setRenderHint(QPainter::Antialiasing);
+    p.setPen(Qt::NoPen);
+    p.setBrush(color);
+    p.drawRoundedRect(QRectF(blur, blur, side - 2 * blur, side - 2 * blur),
+                      NodeCornerRadius, NodeCornerRadius);
+  }
+
+  // the blur QGraphicsDropShadowEffect uses too, so both shadow modes match
+  QImage blurred(side, side, QImage::Format_ARGB32_Premultiplied);
+  blurred.fill(0);
+  {
+    QGraphicsScene scene;
+
+    // owned by the item
+    auto effect = new QGraphicsBlurEffect;
+    effect->setBlurRadius(NodeStyle::ShadowBlurRadius);
+
+    QGraphicsPixmapItem item(source);
+    item.setGraphicsEffect(effect);
+    scene.addItem(&item);
+
+    QPainter p(&blurred);
+    scene.render(&p, QRectF(0, 0, side, side), QRectF(0, 0, side, side));
+    p.end();
+
+    scene.removeItem(&item);
+  }
+
+  pixmap = QPixmap::fromImage(blurred);
+
+  QPixmapCache::insert(key, pixmap);
+
+  return pixmap;
+}
+}
+
 void
 NodePainter::
 paint(QPainter* painter,
-      NodeGraphicsObject const & graphicsObject)
+      NodeGraphicsObject const & graphicsObject,
+      double levelOfDetail)
 {
   NodeGeometry const& geom = graphicsObject.geometry();
 
-  NodeState const& state = graphicsObject.nodeState();
-
-  geom.recalculateSize(painter->font());
+  // FlowScene lays the nodes out again when its font changes
+  painter->setFont(geom.font());
 
   //--------------------------------------------
 
+  if (levelOfDetail < FlatDetail)
+  {
+    drawFlatNodeRect(painter, graphicsObject);
+    return;
+  }
+
+  drawShadow(painter, graphicsObject);
+
   drawNodeRect(painter, graphicsObject);
 
   drawConnectionPoints(painter, graphicsObject);
 
   drawFilledConnectionPoints(painter, graphicsObject);
 
+  if (levelOfDetail < SimplifiedDetail)
+    return;
+
   drawModelName(painter, graphicsObject);
 
   drawEntryLabels(painter, graphicsObject);
@@ -55,9 +143,7 @@ void
 NodePainter::
 drawNodeRect(QPainter* painter, NodeGraphicsObject const & graphicsObject)
 {
-  FlowSceneModel& model = *graphicsObject.flowScene().model();
-  
-  NodeStyle const& nodeStyle = model.nodeStyle(graphicsObject.index());
+  NodeStyle const& nodeStyle = graphicsObject.geometry().style();
   NodeGeometry const& nodeGeometry = graphicsObject.geometry();
 
   auto color = graphicsObject.isSelected()
@@ -89,12 +175,58 @@ drawNodeRect(QPainter* painter, NodeGraphicsObject const & graphicsObject)
 
   QRectF boundary( -diam, -diam, 2.0 * diam + nodeGeometry.width(), 2.0 * diam + nodeGeometry.height());
 
-  double const radius = 3.0;
+  double const radius = NodeCornerRadius;
 
   painter->drawRoundedRect(boundary, radius, radius);
 }
 
 
+void
+NodePainter::
+drawShadow(QPainter* painter, NodeGraphicsObject const & graphicsObject)
+{
+  NodeStyle const& nodeStyle = graphicsObject.geometry().style();
+  NodeGeometry const& nodeGeometry = graphicsObject.geometry();
+
+  if (nodeStyle.Shadow != NodeStyle::ShadowMode::Painted)
+    return;
+
+  int margin = 0;
+  QPixmap const pixmap = shadowPixmap(nodeStyle.ShadowColor, margin);
+
+  float diam = nodeStyle.ConnectionPointDiameter;
+
+  QRectF boundary( -diam, -diam, 2.0 * diam + nodeGeometry.width(), 2.0 * diam + nodeGeometry.height());
+
+  double const blur = NodeStyle::ShadowBlurRadius;
+
+  QRectF target = boundary.translated(NodeStyle::ShadowOffset, NodeStyle::ShadowOffset)
+                          .adjusted(-blur, -blur, blur, blur);
+
+  qDrawBorderPixmap(painter, target.toAlignedRect(),
+                    QMargins(margin, margin, margin, margin), pixmap);
+}
+
+
+void
+NodePainter::
+drawFlatNodeRect(QPainter* painter, NodeGraphicsObject const & graphicsObject)
+{
+  NodeStyle const& nodeStyle = graphicsObject.geometry().style();
+  NodeGeometry const& nodeGeometry = graphicsObject.geometry();
+
+  auto color = graphicsObject.isSelected()
+               ? nodeStyle.SelectedBoundaryColor
+               : nodeStyle.GradientColor1;
+
+  float diam = nodeStyle.ConnectionPointDiameter;
+
+  QRectF boundary( -diam, -diam, 2.0 * diam + nodeGeometry.width(), 2.0 * diam + nodeGeometry.height());
+
+  painter->fillRect(boundary, color);
+}
+
+
 void
 NodePainter::
 drawConnectionPoints(QPainter* painter, NodeGraphicsObject const & graphicsObject)
@@ -103,7 +235,7 @@ drawConnectionPoints(QPainter* painter, NodeGraphicsObject const & graphicsObjec
   NodeState const& nodeState       = graphicsObject.nodeState();
   NodeGeometry const& nodeGeometry = graphicsObject.geometry();
   const FlowSceneModel& model      = *graphicsObject.flowScene().model();
-  NodeStyle const& nodeStyle       = model.nodeStyle(graphicsObject.index());
+  NodeStyle const& nodeStyle = graphicsObject.geometry().style();
 
   float diameter = nodeStyle.ConnectionPointDiameter;
   auto  reducedDiameter = diameter * 0.6;
@@ -136,15 +268,15 @@ drawConnectionPoints(QPainter* painter, NodeGraphicsObject const & graphicsObjec
           {
             if (portType == PortType::In)
             {
-              typeConvertable = model.converterNode(nodeState.reactingDataType(), dataType) != "";
+              typeConvertable = model.canConvert(nodeState.reactingDataType(), dataType);
             }
             else
             {
-              typeConvertable = model.converterNode(dataType, nodeState.reactingDataType()) != "";
+              typeConvertable = model.canConvert(dataType, nodeState.reactingDataType());
             }
           }
 
-          if (nodeState.reactingDataType().id == dataType.id || typeConvertable)
+          if (nodeState.reactingDataType().atom() == dataType.atom() || typeConvertable)
           {
             double const thres = 40.0;
             r = (dist < thres) ?
@@ -162,7 +294,7 @@ drawConnectionPoints(QPainter* painter, NodeGraphicsObject const & graphicsObjec
 
         if (connectionStyle.useDataDefinedColors())
         {
-          painter->setBrush(connectionStyle.normalColor(dataType.id));
+          painter->setBrush(connectionStyle.normalColor(dataType.atom()));
         }
         else
         {
@@ -188,7 +320,7 @@ drawFilledConnectionPoints(QPainter * painter, NodeGraphicsObject const & graphi
   NodeState const& state      = graphicsObject.nodeState();
   NodeGeometry const& geom    = graphicsObject.geometry();
   FlowSceneModel const& model = *graphicsObject.index().model();
-  NodeStyle const& nodeStyle  = model.nodeStyle(graphicsObject.index());
+  NodeStyle const& nodeStyle = graphicsObject.geometry().style();
 
   auto diameter = nodeStyle.ConnectionPointDiameter;
 
@@ -207,7 +339,7 @@ drawFilledConnectionPoints(QPainter * painter, NodeGraphicsObject const & graphi
 
           if (connectionStyle.useDataDefinedColors())
           {
-            QColor const c = connectionStyle.normalColor(dataType.id);
+            QColor const c = connectionStyle.normalColor(dataType.atom());
             painter->setPen(c);
             painter->setBrush(c);
           }
@@ -233,11 +365,10 @@ void
 NodePainter::
 drawModelName(QPainter * painter, NodeGraphicsObject const & graphicsObject)
 {
-  NodeStyle const& nodeStyle = graphicsObject.index().model()->nodeStyle(graphicsObject.index());
-  FlowSceneModel const& model = *graphicsObject.index().model();
+  NodeStyle const& nodeStyle = graphicsObject.geometry().style();
   NodeGeometry const& geom = graphicsObject.geometry();
 
-  QString const &name = model.nodeCaption(graphicsObject.index());
+  QString const &name = geom.caption();
   
   if (name.isEmpty()) {
     return;
@@ -247,16 +378,11 @@ drawModelName(QPainter * painter, NodeGraphicsObject const & graphicsObject)
 
   f.setBold(true);
 
-  QFontMetrics metrics(f);
-
-  auto rect = metrics.boundingRect(name);
-
-  QPointF position((geom.width() - rect.width()) / 2.0,
+  QPointF position((geom.width() - geom.captionWidth()) / 2.0,
                    (geom.spacing() + geom.entryHeight()) / 3.0);
 
-  painter->setFont(f);
   painter->setPen(nodeStyle.FontColor);
-  painter->drawText(position, name);
+  StaticTextCache::draw(painter, position, name, f);
 
   f.setBold(false);
   painter->setFont(f);
@@ -269,14 +395,12 @@ drawEntryLabels(QPainter * painter, NodeGraphicsObject const & graphicsObject)
 {
   NodeState const& state = graphicsObject.nodeState();
   NodeGeometry const& geom = graphicsObject.geometry();
-  FlowSceneModel const& model = *graphicsObject.index().model();
-  QFontMetrics const & metrics =
-    painter->fontMetrics();
+  QFont const font = painter->font();
 
   auto drawPoints =
     [&](PortType portType)
     {
-      auto const &nodeStyle = graphicsObject.index().model()->nodeStyle(graphicsObject.index());
+      auto const &nodeStyle = geom.style();
 
       auto& entries = state.getEntries(portType);
 
@@ -291,14 +415,9 @@ drawEntryLabels(QPainter * painter, NodeGraphicsObject const & graphicsObject)
         else
           painter->setPen(nodeStyle.FontColor);
 
-        QString s = model.nodePortCaption(graphicsObject.index(), portType, i);
+        QString const& s = geom.portLabel(portType, i);
 
-        if (s.isEmpty())
-        {
-          s = model.nodePortDataType(graphicsObject.index(), portType, i).name;
-        }
-
-        auto rect = metrics.boundingRect(s);
+        auto const& rect = geom.portLabelRect(portType, i);
 
         p.setY(p.y() + rect.height() / 4.0);
 
@@ -316,7 +435,7 @@ drawEntryLabels(QPainter * painter, NodeGraphicsObject const & graphicsObject)
             break;
         }
 
-        painter->drawText(p, s);
+        StaticTextCache::draw(painter, p, s, font);
       }
     };
 
@@ -353,7 +472,7 @@ drawValidationRect(QPainter * painter, NodeGraphicsObject const & graphicsObject
 
   if (modelValidationState != NodeValidationState::Valid)
   {
-    NodeStyle const& nodeStyle = model.nodeStyle(graphicsObject.index());
+    NodeStyle const& nodeStyle = graphicsObject.geometry().style();
 
     auto color = graphicsObject.isSelected()
                  ? nodeStyle.SelectedBoundaryColor
@@ -398,16 +517,13 @@ drawValidationRect(QPainter * painter, NodeGraphicsObject const & graphicsObject
 
     QFont f = painter->font();
 
-    QFontMetrics metrics(f);
-
-    auto rect = metrics.boundingRect(errorMsg);
+    auto rect = StaticTextCache::entry(errorMsg, f).boundingRect;
 
     QPointF position((geom.width() - rect.width()) / 2.0,
                      geom.height() - (geom.validationHeight() - diam) / 2.0);
 
-    painter->setFont(f);
     painter->setPen(nodeStyle.FontColor);
-    painter->drawText(position, errorMsg);
+    StaticTextCache::draw(painter, position, errorMsg, f);
   }
 }
 
@@ -21,16 +21,32 @@ public:
 
 public:
 
+  /// `levelOfDetail` is the view scale, as reported by
+  /// QStyleOptionGraphicsItem::levelOfDetailFromTransform(). Zoomed out
+  /// nodes are drawn as boxes without text, far out as flat rectangles.
   static
   void
   paint(QPainter* painter,
-        NodeGraphicsObject const & graphicsObject);
+        NodeGraphicsObject const & graphicsObject,
+        double levelOfDetail = 1.0);
 
   static
   void
   drawNodeRect(QPainter* painter,
                NodeGraphicsObject const & graphicsObject);
 
+  /// NodeStyle::ShadowMode::Painted only, the other modes draw nothing
+  static
+  void
+  drawShadow(QPainter* painter,
+             NodeGraphicsObject const & graphicsObject);
+
+  /// Single flat fill, no gradient, outline or text
+  static
+  void
+  drawFlatNodeRect(QPainter* painter,
+                   NodeGraphicsObject const & graphicsObject);
+
   static
   void
   drawModelName(QPainter* painter, NodeGraphicsObject const & graphicsObject);
@@ -14,6 +14,9 @@
 
 using QtNodes::NodeStyle;
 
+constexpr qreal NodeStyle::ShadowBlurRadius;
+constexpr qreal NodeStyle::ShadowOffset;
+
 inline void initResources() { Q_INIT_RESOURCE(resources); }
 
 NodeStyle::
@@ -133,4 +136,13 @@ loadJsonFromByteArray(QByteArray const &byteArray)
   NODE_STYLE_READ_FLOAT(obj, ConnectionPointDiameter);
 
   NODE_STYLE_READ_FLOAT(obj, Opacity);
+
+  // unknown or missing values keep the mode
+  QString const shadow = obj["Shadow"].toString();
+  if (shadow == "None")
+    Shadow = ShadowMode::None;
+  else if (shadow == "Effect")
+    Shadow = ShadowMode::Effect;
+  else if (shadow == "Painted")
+    Shadow = ShadowMode::Painted;
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+
 #include <QtGui/QColor>
 
 #include "Export.hpp"
@@ -10,6 +12,20 @@ namespace QtNodes
 
 class NODE_EDITOR_PUBLIC NodeStyle : public Style
 {
+public:
+
+  /// How nodes cast their shadow
+  enum class ShadowMode
+  {
+    None,
+    /// A QGraphicsDropShadowEffect per node. Every update of a node is
+    /// rendered offscreen and blurred again.
+    Effect,
+    /// A blurred rounded rectangle rendered once per ShadowColor and
+    /// stretched to each node as a nine-patch by NodePainter
+    Painted
+  };
+
 public:
 
   NodeStyle();
@@ -52,5 +68,15 @@ public:
   float ConnectionPointDiameter;
 
   float Opacity;
+
+  ShadowMode Shadow = ShadowMode::Effect;
+
+  /// Shadows of both modes are blurred and offset by this much
+  static constexpr qreal ShadowBlurRadius = 20.0;
+  static constexpr qreal ShadowOffset     = 4.0;
 };
+
+/// Shared, immutable style. Views hold on to these instead of copying the
+/// style; a new style means a new handle.
+using NodeStyleHandle = std::shared_ptr<NodeStyle const>;
 }
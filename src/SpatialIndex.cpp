@@ -0,0 +1,213 @@
+#include "SpatialIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "NodeGraphicsObject.hpp"
+
+namespace QtNodes
+{
+
+namespace
+{
+
+// a few cells per node at the default style
+constexpr double CellSize = 256.0;
+}
+
+
+void
+SpatialIndex::
+update(NodeGraphicsObject* ngo)
+{
+  QRectF const rect = ngo->sceneBoundingRect();
+
+  auto iter = _entries.find(ngo);
+
+  if (iter == _entries.end())
+  {
+    _entries.emplace(ngo, Entry{rect, _nextOrder++});
+
+    insertIntoCells(ngo, rect);
+
+    return;
+  }
+
+  if (iter->second.rect == rect)
+    return;
+
+  removeFromCells(ngo, iter->second.rect);
+
+  iter->second.rect = rect;
+
+  insertIntoCells(ngo, rect);
+}
+
+
+void
+SpatialIndex::
+remove(NodeGraphicsObject* ngo)
+{
+  auto iter = _entries.find(ngo);
+
+  if (iter == _entries.end())
+    return;
+
+  removeFromCells(ngo, iter->second.rect);
+
+  _entries.erase(iter);
+}
+
+
+void
+SpatialIndex::
+clear()
+{
+  _entries.clear();
+  _cells.clear();
+}
+
+
+NodeGraphicsObject*
+SpatialIndex::
+nodeAt(QPointF const& scenePoint) const
+{
+  auto nodes = cell(scenePoint);
+
+  if (nodes == nullptr)
+    return nullptr;
+
+  NodeGraphicsObject* result = nullptr;
+
+  for (NodeGraphicsObject* ngo : *nodes)
+  {
+    if (!ngo->isVisible() || !_entries.at(ngo).rect.contains(scenePoint))
+      continue;
+
+    if (result == nullptr || above(ngo, result))
+      result = ngo;
+  }
+
+  return result;
+}
+
+
+std::pair<NodeGraphicsObject*, PortIndex>
+SpatialIndex::
+portAt(QPointF const& scenePoint, PortType portType) const
+{
+  std::pair<NodeGraphicsObject*, PortIndex> result(nullptr, INVALID);
+
+  auto nodes = cell(scenePoint);
+
+  if (nodes == nullptr)
+    return result;
+
+  for (NodeGraphicsObject* ngo : *nodes)
+  {
+    // the bounding rect covers the hit area of the ports
+    if (!ngo->isVisible() || !_entries.at(ngo).rect.contains(scenePoint))
+      continue;
+
+    if (result.first != nullptr && !above(ngo, result.first))
+      continue;
+
+    PortIndex portIndex =
+      ngo->geometry().checkHitScenePoint(portType,
+                                         scenePoint,
+                                         ngo->sceneTransform());
+
+    if (portIndex != INVALID)
+      result = std::make_pair(ngo, portIndex);
+  }
+
+  return result;
+}
+
+
+SpatialIndex::CellKey
+SpatialIndex::
+cellKey(int x, int y)
+{
+  return (static_cast<CellKey>(static_cast<quint32>(x)) << 32) |
+         static_cast<quint32>(y);
+}
+
+
+int
+SpatialIndex::
+cellCoordinate(double v)
+{
+  return static_cast<int>(std::floor(v / CellSize));
+}
+
+
+void
+SpatialIndex::
+insertIntoCells(NodeGraphicsObject* ngo, QRectF const& rect)
+{
+  for (int x = cellCoordinate(rect.left()); x <= cellCoordinate(rect.right()); ++x)
+  {
+    for (int y = cellCoordinate(rect.top()); y <= cellCoordinate(rect.bottom()); ++y)
+    {
+      _cells[cellKey(x, y)].push_back(ngo);
+    }
+  }
+}
+
+
+void
+SpatialIndex::
+removeFromCells(NodeGraphicsObject* ngo, QRectF const& rect)
+{
+  for (int x = cellCoordinate(rect.left()); x <= cellCoordinate(rect.right()); ++x)
+  {
+    for (int y = cellCoordinate(rect.top()); y <= cellCoordinate(rect.bottom()); ++y)
+    {
+      auto iter = _cells.find(cellKey(x, y));
+
+      if (iter == _cells.end())
+        continue;
+
+      auto& nodes = iter->second;
+
+      auto node = std::find(nodes.begin(), nodes.end(), ngo);
+
+      if (node != nodes.end())
+      {
+        // order within a cell doesn't matter
+        *node = nodes.back();
+        nodes.pop_back();
+      }
+
+      if (nodes.empty())
+        _cells.erase(iter);
+    }
+  }
+}
+
+
+std::vector<NodeGraphicsObject*> const*
+SpatialIndex::
+cell(QPointF const& scenePoint) const
+{
+  auto iter = _cells.find(cellKey(cellCoordinate(scenePoint.x()),
+                                  cellCoordinate(scenePoint.y())));
+
+  if (iter == _cells.end())
+    return nullptr;
+
+  return &iter->second;
+}
+
+
+bool
+SpatialIndex::
+above(NodeGraphicsObject* lhs, NodeGraphicsObject* rhs) const
+{
+  if (lhs->zValue() != rhs->zValue())
+    return lhs->zValue() > rhs->zValue();
+
+  return _entries.at(lhs).order > _entries.at(rhs).order;
+}
+}
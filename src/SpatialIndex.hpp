@@ -0,0 +1,90 @@
+#pragma once
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <QtCore/QPointF>
+#include <QtCore/QRectF>
+
+#include "PortType.hpp"
+
+namespace QtNodes
+{
+
+class NodeGraphicsObject;
+
+/// Uniform grid over the scene bounding rects of the node graphics
+/// objects, so hit tests only look at the nodes in the cell under the
+/// point instead of every item of the scene.
+///
+/// FlowScene keeps it current: nodes update their entry whenever their
+/// position or size changes, and the scene removes them before deleting
+/// them.
+class SpatialIndex
+{
+public:
+
+  /// Inserts the node, or moves it to the cells of its current
+  /// sceneBoundingRect(). Cheap if the rect didn't change.
+  void
+  update(NodeGraphicsObject* ngo);
+
+  void
+  remove(NodeGraphicsObject* ngo);
+
+  void
+  clear();
+
+  /// Topmost node whose bounding rect contains `scenePoint`
+  NodeGraphicsObject*
+  nodeAt(QPointF const& scenePoint) const;
+
+  /// Topmost node with a port of `portType` within hit distance of
+  /// `scenePoint`, and that port. {nullptr, INVALID} if there is none.
+  std::pair<NodeGraphicsObject*, PortIndex>
+  portAt(QPointF const& scenePoint, PortType portType) const;
+
+private:
+
+  struct Entry
+  {
+    QRectF rect;
+
+    // insertion order, later nodes stack above earlier ones of the same z
+    quint64 order;
+  };
+
+  using CellKey = quint64;
+
+  static
+  CellKey
+  cellKey(int x, int y);
+
+  static
+  int
+  cellCoordinate(double v);
+
+  void
+  insertIntoCells(NodeGraphicsObject* ngo, QRectF const& rect);
+
+  void
+  removeFromCells(NodeGraphicsObject* ngo, QRectF const& rect);
+
+  /// Nodes whose cells include the one under `scenePoint`
+  std::vector<NodeGraphicsObject*> const*
+  cell(QPointF const& scenePoint) const;
+
+  /// Whether `lhs` is drawn above `rhs`
+  bool
+  above(NodeGraphicsObject* lhs, NodeGraphicsObject* rhs) const;
+
+private:
+
+  std::unordered_map<NodeGraphicsObject*, Entry> _entries;
+
+  std::unordered_map<CellKey, std::vector<NodeGraphicsObject*>> _cells;
+
+  quint64 _nextOrder = 0;
+};
+}
@@ -0,0 +1,111 @@
+#include "StaticTextCache.hpp"
+
+#include <QtGui/QFontMetrics>
+#include <QtGui/QPainter>
+
+namespace QtNodes {
+
+namespace {
+constexpr int DefaultCapacity = 4096;
+}
+
+StaticTextCache::
+StaticTextCache()
+  : _entries(DefaultCapacity)
+{}
+
+
+StaticTextCache::Entry
+StaticTextCache::
+entry(QString const& string, QFont const& font)
+{
+  auto& cache = instance();
+
+  Key key{string, font};
+
+  if (Entry* cached = cache._entries.object(key))
+  {
+    ++cache._statistics.hits;
+
+    return *cached;
+  }
+
+  ++cache._statistics.misses;
+
+  QFontMetrics metrics(font);
+
+  auto entry = new Entry;
+
+  entry->text = QStaticText(string);
+  entry->text.setTextFormat(Qt::PlainText);
+  entry->text.setPerformanceHint(QStaticText::AggressiveCaching);
+  entry->text.prepare(QTransform(), font);
+
+  entry->boundingRect = metrics.boundingRect(string);
+  entry->advance      = metrics.width(string);
+  entry->ascent       = metrics.ascent();
+
+  Entry result = *entry;
+
+  cache._entries.insert(key, entry);
+
+  return result;
+}
+
+
+void
+StaticTextCache::
+draw(QPainter* painter,
+     QPointF const& baseline,
+     QString const& string,
+     QFont const& font)
+{
+  Entry e = entry(string, font);
+
+  painter->setFont(font);
+  painter->drawStaticText(baseline - QPointF(0.0, e.ascent), e.text);
+}
+
+
+StaticTextCache::Statistics
+StaticTextCache::
+statistics()
+{
+  return instance()._statistics;
+}
+
+
+void
+StaticTextCache::
+resetStatistics()
+{
+  instance()._statistics = Statistics();
+}
+
+
+void
+StaticTextCache::
+clear()
+{
+  instance()._entries.clear();
+}
+
+
+void
+StaticTextCache::
+setCapacity(int capacity)
+{
+  instance()._entries.setMaxCost(capacity);
+}
+
+
+StaticTextCache&
+StaticTextCache::
+instance()
+{
+  static StaticTextCache cache;
+
+  return cache;
+}
+
+} // namespace QtNodes
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <QtCore/QCache>
+#include <QtCore/QPointF>
+#include <QtCore/QRect>
+#include <QtCore/QString>
+#include <QtGui/QFont>
+#include <QtGui/QStaticText>
+
+#include "Export.hpp"
+
+class QPainter;
+
+namespace QtNodes
+{
+
+/// Process-wide cache of laid out text, keyed by string and font.
+///
+/// Graphs built from one registry repeat the same few hundred captions and
+/// port labels over and over; each is shaped and measured once and then
+/// shared by NodeGeometry (for measuring) and NodePainter (for drawing).
+/// Like the painting that uses it, it is meant for the GUI thread only.
+class NODE_EDITOR_PUBLIC StaticTextCache
+{
+public:
+
+  struct Entry
+  {
+    QStaticText text;
+
+    /// QFontMetrics::boundingRect() of the string
+    QRect boundingRect;
+
+    /// QFontMetrics::width() of the string
+    int advance = 0;
+
+    /// Distance from the top of `text` to its baseline
+    int ascent = 0;
+  };
+
+  struct Statistics
+  {
+    quint64 hits   = 0;
+    quint64 misses = 0;
+  };
+
+public:
+
+  static
+  Entry
+  entry(QString const& string, QFont const& font);
+
+  /// Draws like QPainter::drawText(baseline, string) with `font`
+  static
+  void
+  draw(QPainter* painter,
+       QPointF const& baseline,
+       QString const& string,
+       QFont const& font);
+
+  static
+  Statistics
+  statistics();
+
+  static
+  void
+  resetStatistics();
+
+  /// Drops every entry, statistics are kept
+  static
+  void
+  clear();
+
+  /// Maximal number of entries, least recently used ones are evicted
+  static
+  void
+  setCapacity(int capacity);
+
+private:
+
+  StaticTextCache();
+
+  StaticTextCache(StaticTextCache const&) = delete;
+
+  StaticTextCache&
+  operator=(StaticTextCache const&) = delete;
+
+  static
+  StaticTextCache&
+  instance();
+
+private:
+
+  struct Key
+  {
+    QString string;
+    QFont   font;
+
+    bool
+    operator==(Key const& other) const
+    { return string == other.string && font == other.font; }
+  };
+
+  friend uint
+  qHash(Key const& key, uint seed)
+  { return qHash(key.string, seed) ^ qHash(key.font, seed); }
+
+  QCache<Key, Entry> _entries;
+
+  Statistics _statistics;
+};
+}
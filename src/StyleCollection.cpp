@@ -8,6 +8,14 @@ using QtNodes::FlowViewStyle;
 NodeStyle const&
 StyleCollection::
 nodeStyle()
+{
+  return *instance()._nodeStyle;
+}
+
+
+NodeStyleHandle
+StyleCollection::
+nodeStyleHandle()
 {
   return instance()._nodeStyle;
 }
@@ -33,7 +41,7 @@ void
 StyleCollection::
 setNodeStyle(NodeStyle nodeStyle)
 {
-  instance()._nodeStyle = nodeStyle;
+  instance()._nodeStyle = std::make_shared<NodeStyle const>(std::move(nodeStyle));
 }
 
 
@@ -15,6 +15,10 @@ public:
   NodeStyle const&
   nodeStyle();
 
+  static
+  NodeStyleHandle
+  nodeStyleHandle();
+
   static
   ConnectionStyle const&
   connectionStyle();
@@ -52,7 +56,7 @@ private:
 
 private:
 
-  NodeStyle _nodeStyle;
+  NodeStyleHandle _nodeStyle = std::make_shared<NodeStyle const>();
 
   ConnectionStyle _connectionStyle;
 